@@ -1,6 +1,7 @@
 #include "utils/hash/murmur2_hash.hpp"
 
 #include "include/cuckoo_dysect.hpp"
+#include <string>
 #include <unordered_map>
 
 
@@ -69,4 +70,14 @@ int main(int, char**)
     // ACCESSOR
     dysect_standard[42] = 666;
     // this inserts 666 with key 42 or replaces the previous value with that key
+
+
+
+    // NON-TRIVIAL MAPPED TYPES
+    dysect::cuckoo_dysect<key_type, std::string> dysect_string(1000, 1.1);
+    for (size_t i = 1; i <= 10000; ++i) // grows (i.e. allocates subtables)
+        dysect_string.insert(i, std::to_string(i));
+    auto it3 = dysect_string.find(4711);
+    if (it3 == dysect_string.end() || it3->second != "4711")
+        std::cout << "key 4711 - string was lost while growing!" << std::endl;
 }
@@ -15,8 +15,13 @@
  ******************************************************************************/
 
 #include <cstddef>
+#include <cstdint>
 #include <tuple>
 
+#include <immintrin.h>
+
+#include "element_traits.hpp"
+
 namespace dysect
 {
 
@@ -42,6 +47,7 @@ template <class K, class D, size_t BS = 4> class bucket
     bool             insert(const key_type& k, const mapped_type& d);
     bool             insert(const value_intern& t);
     find_return_type find(const key_type& k);
+    find_return_type find_relaxed(const key_type& k) const;
     bool             remove(const key_type& k);
     find_return_type pop(const key_type& k);
 
@@ -104,6 +110,28 @@ bucket<K, D, BS>::find(const key_type& k)
     return std::make_pair(false, mapped_type());
 }
 
+// find for concurrent readers (see bucket_versions in cuckoo_base.hpp),
+// slots are read with relaxed atomic loads, the result is only valid if
+// the bucket version did not change meanwhile
+template <class K, class D, size_t BS>
+inline typename bucket<K, D, BS>::find_return_type
+bucket<K, D, BS>::find_relaxed(const key_type& k) const
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        key_type tk;
+        __atomic_load(&elements[i].first, &tk, __ATOMIC_RELAXED);
+        if (!tk) break;
+        if (tk == k)
+        {
+            mapped_type d;
+            __atomic_load(&elements[i].second, &d, __ATOMIC_RELAXED);
+            return std::make_pair(true, d);
+        }
+    }
+    return std::make_pair(false, mapped_type());
+}
+
 template <class K, class D, size_t BS>
 inline bool bucket<K, D, BS>::remove(const key_type& k)
 {
@@ -246,4 +274,424 @@ bucket<K, D, BS>::probe_ptr(const key_type& k)
     return std::make_pair(0, nullptr);
 }
 
+
+
+
+// Packed 32-bit buckets *******************************************************
+// pairs of 32-bit keys and values take 8 bytes, i.e., a bucket with BS=8
+// fills one cache line.  Keys are compared with SIMD instructions, key 0
+// is reserved for empty slots and is never found.
+
+template <size_t BS> class bucket<uint32_t, uint32_t, BS>
+{
+  public:
+    using key_type    = uint32_t;
+    using mapped_type = uint32_t;
+
+  private:
+    using value_intern = std::pair<key_type, mapped_type>;
+
+    static_assert(sizeof(value_intern) == 8, "32-bit pairs are not packed");
+    static_assert(BS <= 32, "match masks are limited to 32 elements");
+
+  public:
+    using find_return_type = std::pair<bool, mapped_type>;
+
+    bucket()
+    {
+        for (size_t i = 0; i < BS; ++i) elements[i] = value_intern();
+    }
+    bucket(const bucket& rhs) = default;
+    bucket& operator=(const bucket& rhs) = default;
+
+    bool             insert(const key_type& k, const mapped_type& d);
+    bool             insert(const value_intern& t);
+    find_return_type find(const key_type& k);
+    find_return_type find_relaxed(const key_type& k) const;
+    bool             remove(const key_type& k);
+    find_return_type pop(const key_type& k);
+
+    int probe(const key_type& k);
+    int displacement(const key_type& k) const;
+
+    bool         space();
+    value_intern get(const size_t i);
+    value_intern replace(const size_t i, const value_intern& t);
+
+
+    value_intern*                 insert_ptr(const value_intern& t);
+    const value_intern*           find_ptr(const key_type& k) const;
+    value_intern*                 find_ptr(const key_type& k);
+    std::pair<int, value_intern*> probe_ptr(const key_type& k);
+
+    value_intern elements[BS];
+
+  private:
+    // bit 2i is set iff elements[i].first == k (odd bits belong to values)
+    inline uint64_t match(key_type k) const;
+    inline uint64_t match_key(key_type k) const { return (k) ? match(k) : 0; }
+    inline size_t   first(uint64_t mask) const
+    {
+        return (mask) ? __builtin_ctzll(mask) >> 1 : BS;
+    }
+};
+
+
+template <size_t BS>
+inline uint64_t bucket<uint32_t, uint32_t, BS>::match(key_type k) const
+{
+    constexpr uint64_t key_bits = 0x5555555555555555ull;
+
+    auto     lanes = reinterpret_cast<const uint32_t*>(elements);
+    uint64_t mask  = 0;
+    size_t   i     = 0;
+#ifdef __AVX2__
+    const __m256i vk8 = _mm256_set1_epi32(k);
+    for (; i + 4 <= BS; i += 4)
+    {
+        auto v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(lanes + 2 * i));
+        uint64_t r = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, vk8)));
+        mask |= r << (2 * i);
+    }
+#endif
+    const __m128i vk4 = _mm_set1_epi32(k);
+    for (; i + 2 <= BS; i += 2)
+    {
+        auto v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 2 * i));
+        uint64_t r =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, vk4)));
+        mask |= r << (2 * i);
+    }
+    if (i < BS && elements[i].first == k) mask |= 1ull << (2 * i);
+    return mask & key_bits;
+}
+
+template <size_t BS>
+inline bool
+bucket<uint32_t, uint32_t, BS>::insert(const key_type& k, const mapped_type& d)
+{
+    return insert(std::make_pair(k, d));
+}
+
+template <size_t BS>
+inline bool bucket<uint32_t, uint32_t, BS>::insert(const value_intern& t)
+{
+    return insert_ptr(t);
+}
+
+template <size_t BS>
+inline typename bucket<uint32_t, uint32_t, BS>::find_return_type
+bucket<uint32_t, uint32_t, BS>::find(const key_type& k)
+{
+    auto i = first(match_key(k));
+    if (i < BS) return std::make_pair(true, elements[i].second);
+    return std::make_pair(false, mapped_type());
+}
+
+// scalar, pairs are loaded as one word (see the generic find_relaxed)
+template <size_t BS>
+inline typename bucket<uint32_t, uint32_t, BS>::find_return_type
+bucket<uint32_t, uint32_t, BS>::find_relaxed(const key_type& k) const
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        uint64_t w;
+        __atomic_load(reinterpret_cast<const uint64_t*>(&elements[i]), &w,
+                      __ATOMIC_RELAXED);
+        // little endian, the key is the lower half
+        if (!uint32_t(w)) break;
+        if (uint32_t(w) == k) return std::make_pair(true, uint32_t(w >> 32));
+    }
+    return std::make_pair(false, mapped_type());
+}
+
+template <size_t BS>
+inline bool bucket<uint32_t, uint32_t, BS>::remove(const key_type& k)
+{
+    auto i = first(match_key(k));
+    if (i >= BS) return false;
+
+    auto j      = first(match(0)) - 1;
+    elements[i] = elements[j];
+    elements[j] = value_intern();
+    return true;
+}
+
+template <size_t BS>
+inline typename bucket<uint32_t, uint32_t, BS>::find_return_type
+bucket<uint32_t, uint32_t, BS>::pop(const key_type& k)
+{
+    auto i = first(match_key(k));
+    if (i >= BS) return std::make_pair(false, mapped_type());
+
+    mapped_type d = elements[i].second;
+    auto        j = first(match(0));
+    for (; i + 1 < j; ++i) elements[i] = elements[i + 1];
+    elements[i] = value_intern();
+    return std::make_pair(true, d);
+}
+
+template <size_t BS>
+inline int bucket<uint32_t, uint32_t, BS>::probe(const key_type& k)
+{
+    return probe_ptr(k).first;
+}
+
+template <size_t BS>
+inline int
+bucket<uint32_t, uint32_t, BS>::displacement(const key_type& k) const
+{
+    return first(match_key(k));
+}
+
+template <size_t BS> inline bool bucket<uint32_t, uint32_t, BS>::space()
+{
+    return !elements[BS - 1].first;
+}
+
+template <size_t BS>
+inline std::pair<uint32_t, uint32_t>
+bucket<uint32_t, uint32_t, BS>::get(size_t i)
+{
+    return elements[i];
+}
+
+template <size_t BS>
+inline std::pair<uint32_t, uint32_t>
+bucket<uint32_t, uint32_t, BS>::replace(size_t i, const value_intern& newE)
+{
+    auto temp   = elements[i];
+    elements[i] = newE;
+    return temp;
+}
+
+
+template <size_t BS>
+inline std::pair<uint32_t, uint32_t>*
+bucket<uint32_t, uint32_t, BS>::insert_ptr(const value_intern& t)
+{
+    auto i = first(match(0));
+    if (i >= BS) return nullptr;
+
+    elements[i] = t;
+    return &elements[i];
+}
+
+template <size_t BS>
+inline std::pair<uint32_t, uint32_t>*
+bucket<uint32_t, uint32_t, BS>::find_ptr(const key_type& k)
+{
+    auto i = first(match_key(k));
+    return (i < BS) ? &elements[i] : nullptr;
+}
+
+template <size_t BS>
+inline const std::pair<uint32_t, uint32_t>*
+bucket<uint32_t, uint32_t, BS>::find_ptr(const key_type& k) const
+{
+    auto i = first(match_key(k));
+    return (i < BS) ? &elements[i] : nullptr;
+}
+
+template <size_t BS>
+inline std::pair<int, std::pair<uint32_t, uint32_t>*>
+bucket<uint32_t, uint32_t, BS>::probe_ptr(const key_type& k)
+{
+    auto f = first(match_key(k));
+    if (f < BS) return std::make_pair(-1, &elements[f]);
+
+    auto i = first(match(0));
+    if (i < BS) return std::make_pair(int(BS - i), &elements[i]);
+    return std::make_pair(0, nullptr);
+}
+
+
+
+// Key only buckets (mapped_type void) *****************************************
+// all elements are stored in the beginning of the bucket (like above)
+
+template <class K, size_t BS> class bucket<K, void, BS>
+{
+  public:
+    using key_type    = K;
+    using mapped_type = void;
+
+  private:
+    using value_intern = key_only<key_type>;
+
+  public:
+    using find_return_type = bool;
+
+    bucket()
+    {
+        for (size_t i = 0; i < BS; ++i) elements[i] = value_intern();
+    }
+    bucket(const bucket& rhs) = default;
+    bucket& operator=(const bucket& rhs) = default;
+
+    bool             insert(const value_intern& t);
+    find_return_type find(const key_type& k);
+    bool             remove(const key_type& k);
+    find_return_type pop(const key_type& k);
+
+    int probe(const key_type& k);
+    int displacement(const key_type& k) const;
+
+    bool         space();
+    value_intern get(const size_t i);
+    value_intern replace(const size_t i, const value_intern& t);
+
+
+    value_intern*                 insert_ptr(const value_intern& t);
+    const value_intern*           find_ptr(const key_type& k) const;
+    value_intern*                 find_ptr(const key_type& k);
+    std::pair<int, value_intern*> probe_ptr(const key_type& k);
+
+    value_intern elements[BS];
+};
+
+
+template <class K, size_t BS>
+inline bool bucket<K, void, BS>::insert(const value_intern& t)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (elements[i].first) continue;
+
+        elements[i] = t;
+        return true;
+    }
+
+    return false;
+}
+
+template <class K, size_t BS>
+inline bool bucket<K, void, BS>::find(const key_type& k)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (!elements[i].first) return false;
+        if (elements[i].first == k) return true;
+    }
+    return false;
+}
+
+template <class K, size_t BS>
+inline bool bucket<K, void, BS>::remove(const key_type& k)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (elements[i].first == k)
+        {
+            size_t j = BS - 1;
+            for (; !elements[j].first; --j) {}
+            elements[i] = elements[j];
+            elements[j] = value_intern();
+            return true;
+        }
+        else if (!elements[i].first)
+        {
+            break;
+        }
+    }
+    return false;
+}
+
+template <class K, size_t BS>
+inline bool bucket<K, void, BS>::pop(const key_type& k)
+{
+    return remove(k);
+}
+
+template <class K, size_t BS>
+inline int bucket<K, void, BS>::probe(const key_type& k)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (!elements[i].first) return BS - i;
+        if (elements[i].first == k) return -1;
+    }
+    return 0;
+}
+
+template <class K, size_t BS>
+inline int bucket<K, void, BS>::displacement(const key_type& k) const
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (elements[i].first == k) return i;
+    }
+    return BS;
+}
+
+template <class K, size_t BS> inline bool bucket<K, void, BS>::space()
+{
+    return !elements[BS - 1].first;
+}
+
+template <class K, size_t BS>
+inline key_only<K> bucket<K, void, BS>::get(size_t i)
+{
+    return elements[i];
+}
+
+template <class K, size_t BS>
+inline key_only<K>
+bucket<K, void, BS>::replace(size_t i, const value_intern& newE)
+{
+    auto temp   = elements[i];
+    elements[i] = newE;
+    return temp;
+}
+
+
+template <class K, size_t BS>
+inline key_only<K>* bucket<K, void, BS>::insert_ptr(const value_intern& t)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (elements[i].first) continue;
+
+        elements[i] = t;
+        return &elements[i];
+    }
+
+    return nullptr;
+}
+
+template <class K, size_t BS>
+inline key_only<K>* bucket<K, void, BS>::find_ptr(const key_type& k)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (elements[i].first == k) return &elements[i];
+    }
+    return nullptr;
+}
+
+template <class K, size_t BS>
+inline const key_only<K>* bucket<K, void, BS>::find_ptr(const key_type& k) const
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (elements[i].first == k) return &elements[i];
+    }
+    return nullptr;
+}
+
+template <class K, size_t BS>
+inline std::pair<int, key_only<K>*>
+bucket<K, void, BS>::probe_ptr(const key_type& k)
+{
+    for (size_t i = 0; i < BS; ++i)
+    {
+        if (!elements[i].first) return std::make_pair(BS - i, &elements[i]);
+        if (elements[i].first == k) return std::make_pair(-1, &elements[i]);
+    }
+    return std::make_pair(0, nullptr);
+}
+
 } // namespace dysect
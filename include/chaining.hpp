@@ -3,8 +3,10 @@
 /*******************************************************************************
  * include/chaining.hpp
  *
- * prob_base is similar to cuckoo_base, in that it encapsules
- * everything, that all probing based hash tables have in common.
+ * chaining implements hashing with separate chaining.  Nodes are
+ * allocated from a slab (chunks of 2^16 nodes with an intrusive free
+ * list) and are linked with 32-bit indices, growing relinks the nodes
+ * into a larger bucket array without reallocating them.
  *
  * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
  *
@@ -13,8 +15,12 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <new>
 #include <tuple>
 #include <vector>
 
@@ -55,57 +61,31 @@ class chaining
 
   private:
     using value_intern = std::pair<key_type, mapped_type>;
+    // nodes are addressed by their index in the slab, 0 ends a chain
+    using index_type   = uint32_t;
     struct queue_item
     {
-        queue_item*  next;
+        index_type   next;
         value_intern element;
-        queue_item(const std::pair<key_type, mapped_type>& element)
-            : next(nullptr), element(element)
-        {
-        }
     };
 
+    static constexpr size_type chunk_bits = 16;
+    static constexpr size_type chunk_size = 1ull << chunk_bits;
+
   public:
     chaining(size_type cap, double alpha, size_type /*steps*/ = 0)
         : alpha(alpha), beta((alpha + 1.) / 2.), n(0),
           capacity((cap) ? cap * alpha : 2048 * alpha),
-          thresh((cap) ? cap * beta : 2048 * beta)
-    {
-        if (cap) table = std::make_unique<queue_item*[]>(capacity);
-        std::fill(table.get(), table.get() + capacity, nullptr);
-    }
-
-    ~chaining()
+          thresh((cap) ? cap * beta : 2048 * beta), free_list(0), used(1)
     {
-        if (!table) return;
-        for (size_t i = 0; i < capacity; ++i)
-        {
-            auto curr = table[i];
-            while (curr)
-            {
-                auto temp = curr->next;
-                delete curr;
-                curr = temp;
-            }
-        }
+        table = std::make_unique<index_type[]>(capacity);
     }
 
     chaining(const chaining&) = delete;
     chaining& operator=(const chaining&) = delete;
 
-    chaining(chaining&& rhs)
-        : alpha(rhs.alpha), beta(rhs.beta), n(rhs.n), capacity(rhs.capacity),
-          thresh(rhs.thresh), hasher(rhs.hasher), table(std::move(rhs.table))
-    {
-        rhs.table = nullptr;
-    }
-    chaining& operator=(chaining&& rhs)
-    {
-        if (this == &rhs) return *this;
-        this->~this_type();
-        new (this) this_type(std::move(rhs));
-        return *this;
-    }
+    chaining(chaining&& rhs) = default;
+    chaining& operator=(chaining&& rhs) = default;
 
   private:
     /*** members that should become private at some point *********************/
@@ -116,7 +96,12 @@ class chaining
     size_type          thresh;
     hash_function_type hasher;
 
-    std::unique_ptr<queue_item*[]> table;
+    std::unique_ptr<index_type[]> table;
+
+    // slab of nodes, freed nodes are linked through their next index
+    std::vector<std::unique_ptr<queue_item[]> > chunks;
+    index_type                                  free_list;
+    size_type                                   used;
 
   public:
     // Basic Hash Table Functionality ******************************************
@@ -128,18 +113,26 @@ class chaining
     int                       displacement(const key_type& k) const;
     void                      grow();
 
+    // Capacity ****************************************************************
+    // reserve(k) relinks the nodes into buckets for k elements,
+    // shrink_to_fit() also compacts the slab, clear() keeps the buckets
+    // and the allocated chunks
+    void reserve(size_type k);
+    void shrink_to_fit();
+    void clear();
+
     // Easy use Accessors for std compliance ***********************************
     inline iterator       begin();
     inline const_iterator begin() const { return cbegin(); }
     inline const_iterator cbegin() const;
     inline iterator       end()
     {
-        return iterator(nullptr, *this, nullptr, capacity);
+        return iterator(nullptr, *this, 0, capacity);
     }
     inline const_iterator end() const { return cend(); }
     inline const_iterator cend() const
     {
-        return const_iterator(nullptr, *this, nullptr, capacity);
+        return const_iterator(nullptr, *this, 0, capacity);
     }
 
     mapped_type&       at(const key_type& k);
@@ -150,16 +143,24 @@ class chaining
     size_type get_capacity() const { return capacity; }
 
   private:
-    void insert_intern(queue_item* item);
+    // Slab allocation *********************************************************
+    inline queue_item& node(index_type i) const
+    {
+        return chunks[i >> chunk_bits][i & (chunk_size - 1)];
+    }
+    inline index_type new_node(const value_intern& t);
+    inline void       delete_node(index_type i);
+
+    inline void relink(size_type k);
 
     // Easy iterators **********************************************************
-    inline iterator make_iterator(queue_item* item, size_type idx)
+    inline iterator make_iterator(index_type item, size_type idx)
     {
-        return iterator(&(item->element), *this, item, idx);
+        return iterator(&node(item).element, *this, item, idx);
     }
-    inline const_iterator make_citerator(queue_item* item, size_type idx) const
+    inline const_iterator make_citerator(index_type item, size_type idx) const
     {
-        return const_iterator(&(item->element), *this, item, idx);
+        return const_iterator(&node(item).element, *this, item, idx);
     }
 
     // implementation specific functions (static polymorph) ********************
@@ -184,8 +185,8 @@ class chaining
     inline void print_init_data(otm::output_type& out)
     {
         long long overhead =
-            (capacity + n) * sizeof(queue_item*)           // pointer
-            + n * sizeof(std::pair<key_type, mapped_type>) // elements
+            capacity * sizeof(index_type)                        // buckets
+            + chunks.size() * chunk_size * sizeof(queue_item)    // nodes
             - capacity * sizeof(std::pair<key_type, mapped_type>);
         out << otm::width(10) << capacity << otm::width(16) << overhead;
     }
@@ -201,13 +202,9 @@ chaining<K, D, H, C>::find(const key_type& k)
 {
     auto ind = h(k);
 
-    auto curr = table[ind];
-
-    while (curr)
+    for (auto curr = table[ind]; curr; curr = node(curr).next)
     {
-        if (curr->element.first == k) return make_iterator(curr, ind);
-
-        curr = curr->next;
+        if (node(curr).element.first == k) return make_iterator(curr, ind);
     }
     return end();
 }
@@ -218,13 +215,9 @@ chaining<K, D, H, C>::find(const key_type& k) const
 {
     auto ind = h(k);
 
-    auto curr = table[ind];
-
-    while (curr)
+    for (auto curr = table[ind]; curr; curr = node(curr).next)
     {
-        if (curr->element.first == k) return make_citerator(curr, ind);
-
-        curr = curr->next;
+        if (node(curr).element.first == k) return make_citerator(curr, ind);
     }
     return cend();
 }
@@ -240,25 +233,22 @@ template <class K, class D, class H, class C>
 inline std::pair<typename chaining<K, D, H, C>::iterator, bool>
 chaining<K, D, H, C>::insert(const value_intern& t)
 {
-    auto ind = h(t.first);
+    auto  ind  = h(t.first);
+    auto* link = &table[ind];
 
-    auto curr = table[ind];
-    if (!curr)
+    for (; *link; link = &node(*link).next)
     {
-        table[ind] = new queue_item(t);
-        return std::make_pair(make_iterator(curr, ind), true);
-    }
-    while (true)
-    {
-        if (curr->element.first == t.first)
-            return std::make_pair(make_iterator(curr, ind), false);
-        if (!curr->next)
-        {
-            curr->next = new queue_item(t);
-            return std::make_pair(make_iterator(curr, ind), true);
-        }
-        curr = curr->next;
+        if (node(*link).element.first == t.first)
+            return std::make_pair(make_iterator(*link, ind), false);
     }
+
+    // chunks never move, thus link stays valid
+    auto item = new_node(t);
+    *link     = item;
+
+    // nodes do not move when the table grows
+    inc_n();
+    return std::make_pair(make_iterator(item, h(t.first)), true);
 }
 
 template <class K, class D, class H, class C>
@@ -267,26 +257,16 @@ chaining<K, D, H, C>::erase(const key_type& k)
 {
     auto ind = h(k);
 
-    auto curr = table[ind];
-    if (!curr) return 0;
-    if (curr->element.first == k)
-    {
-        table[ind] = curr->next;
-        return 1;
-    }
-
-    auto prev = curr;
-    curr      = curr->next;
-
-    while (curr)
+    for (auto* link = &table[ind]; *link; link = &node(*link).next)
     {
-        if (curr->element.first == k)
+        auto curr = *link;
+        if (node(curr).element.first == k)
         {
-            prev->next = curr->next;
+            *link = node(curr).next;
+            delete_node(curr);
+            dec_n();
             return 1;
         }
-        prev = curr;
-        curr = curr->next;
     }
     return 0;
 }
@@ -296,13 +276,11 @@ inline int chaining<K, D, H, C>::displacement(const key_type& k) const
 {
     auto ind = h(k);
 
-    auto      curr  = table[ind];
     size_type steps = 0;
 
-    while (curr)
+    for (auto curr = table[ind]; curr; curr = node(curr).next)
     {
-        if (curr->element.first == k) return steps;
-        curr = curr->next;
+        if (node(curr).element.first == k) return steps;
         ++steps;
     }
     return -1;
@@ -312,25 +290,94 @@ inline int chaining<K, D, H, C>::displacement(const key_type& k) const
 template <class K, class D, class H, class C>
 inline void chaining<K, D, H, C>::grow()
 {
-    this_type ntable(capacity, alpha);
-    for (size_t i = 0; i < capacity; ++i)
+    relink(n);
+}
+
+template <class K, class D, class H, class C>
+inline void chaining<K, D, H, C>::reserve(size_type k)
+{
+    if (k > thresh) relink(k);
+}
+
+template <class K, class D, class H, class C>
+inline void chaining<K, D, H, C>::shrink_to_fit()
+{
+    // all elements are reinserted into a new slab (without holes)
+    std::vector<value_intern> buffer;
+    buffer.reserve(n);
+    for (auto it = begin(); it != end(); it++) buffer.push_back(*it);
+
+    chunks.clear();
+    free_list = 0;
+    used      = 1;
+
+    size_type k = std::max<size_type>(n, 1);
+    capacity    = std::max<size_type>(k * alpha, 1);
+    thresh      = k * beta;
+    table       = std::make_unique<index_type[]>(capacity);
+    n           = 0;
+
+    for (auto& e : buffer) insert(e);
+}
+
+template <class K, class D, class H, class C>
+inline void chaining<K, D, H, C>::clear()
+{
+    std::fill(table.get(), table.get() + capacity, 0);
+    free_list = 0;
+    used      = 1;
+    n         = 0;
+}
+
+template <class K, class D, class H, class C>
+inline void chaining<K, D, H, C>::relink(size_type k)
+{
+    // nodes are relinked into the new buckets (no reallocation)
+    auto      otable = std::move(table);
+    size_type ocap   = capacity;
+
+    capacity = k * alpha;
+    thresh   = k * beta;
+    table    = std::make_unique<index_type[]>(capacity);
+
+    for (size_t i = 0; i < ocap; ++i)
     {
-        while (table[i])
+        for (auto curr = otable[i]; curr;)
         {
-            auto item = table[i];
-            table[i]  = item->next;
-            ntable.insert_intern(item);
+            auto& item = node(curr);
+            auto  next = item.next;
+            auto  ind  = h(item.element.first);
+            item.next  = table[ind];
+            table[ind] = curr;
+            curr       = next;
         }
     }
-    (*this) = std::move(ntable);
 }
 
 template <class K, class D, class H, class C>
-inline void chaining<K, D, H, C>::insert_intern(queue_item* item)
+inline typename chaining<K, D, H, C>::index_type
+chaining<K, D, H, C>::new_node(const value_intern& t)
 {
-    auto ind   = h(item->element.first);
-    item->next = table[ind];
-    table[ind] = item;
+    index_type i = free_list;
+    if (i) { free_list = node(i).next; }
+    else
+    {
+        if (used > std::numeric_limits<index_type>::max())
+            throw std::bad_alloc();
+        if ((used >> chunk_bits) == chunks.size())
+            chunks.push_back(std::make_unique<queue_item[]>(chunk_size));
+        i = used++;
+    }
+    node(i).next    = 0;
+    node(i).element = t;
+    return i;
+}
+
+template <class K, class D, class H, class C>
+inline void chaining<K, D, H, C>::delete_node(index_type i)
+{
+    node(i).next = free_list;
+    free_list    = i;
 }
 
 // Accessor Implementations ****************************************************
@@ -406,40 +453,31 @@ template <class Chaining> class iterator_incr
     using key_type    = typename table_type::key_type;
     using mapped_type = typename table_type::mapped_type;
     using ipointer    = std::pair<const key_type, mapped_type>*;
-    using qitem       = typename table_type::queue_item;
+    using index_type  = typename table_type::index_type;
 
   public:
-    iterator_incr(const table_type& table, qitem* item, size_t index)
-        : curr_item_ptr(item), table_ptr(&table.table[index]),
-          end_table_ptr(&table.table[table.capacity - 1])
+    iterator_incr(const table_type& table, index_type item, size_t index)
+        : table_ptr(&table), curr_item(item), curr_bucket(index)
     {
     }
     iterator_incr(const iterator_incr&) = default;
     iterator_incr& operator=(const iterator_incr&) = default;
 
-    ipointer next(ipointer cur)
+    ipointer next(ipointer)
     {
-        if (curr_item_ptr->next)
-        {
-            curr_item_ptr = curr_item_ptr->next;
-            return &(curr_item_ptr->element);
-        }
-        while (table_ptr < end_table_ptr)
-        {
-            ++table_ptr;
-            if (*table_ptr)
-            {
-                curr_item_ptr = *table_ptr;
-                return &(curr_item_ptr->element);
-            }
-        }
-        return nullptr;
+        auto next = table_ptr->node(curr_item).next;
+        while (!next && ++curr_bucket < table_ptr->capacity)
+            next = table_ptr->table[curr_bucket];
+        if (!next) return nullptr;
+
+        curr_item = next;
+        return reinterpret_cast<ipointer>(&table_ptr->node(next).element);
     }
 
   private:
-    qitem*  curr_item_ptr;
-    qitem** table_ptr;
-    qitem** end_table_ptr;
+    const table_type* table_ptr;
+    index_type        curr_item;
+    size_t            curr_bucket;
 };
 
 } // namespace dysect
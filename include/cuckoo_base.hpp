@@ -17,18 +17,27 @@
  ******************************************************************************/
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <immintrin.h>
+
 #include "utils/output.hpp"
 
 #include "bucket.hpp"
 #include "displacement_strategies/main_strategies.hpp"
 #include "hasher.hpp"
 #include "iterator_base.hpp"
+#include "zero_memory.hpp"
 
 namespace otm = utils_tm::out_tm;
 
@@ -71,12 +80,165 @@ class history_none
     static constexpr size_t* hist  = nullptr;
 };
 
+// counts insertions whose displacement failed (within windows of
+// Window insertions), tables that implement rehash (cuckoo_dysect)
+// choose new hash functions instead of growing once more than MaxFails
+// insertions of the current window failed
+template <size_t Window = 4096, size_t MaxFails = 2>
+class history_rehash
+{
+  public:
+    history_rehash(size_t = 0) {}
+    void add(size_t)
+    {
+        if (++ops >= Window) clear();
+    }
+    void fail()
+    {
+        ++fails;
+        ++ops;
+    }
+    bool rehash_needed() const { return fails > MaxFails; }
+    void clear()
+    {
+        ops   = 0;
+        fails = 0;
+    }
+    static constexpr size_t  steps = 0;
+    static constexpr size_t* hist  = nullptr;
+
+  private:
+    size_t ops   = 0;
+    size_t fails = 0;
+};
+
+template <class History, class = void>
+struct is_rehash_history : std::false_type
+{
+};
+
+template <class History>
+struct is_rehash_history<
+    History, std::void_t<decltype(std::declval<History&>().fail()),
+                         decltype(std::declval<History&>().rehash_needed())>>
+    : std::true_type
+{
+};
+
+// displacement strategies that move elements by copying them into their
+// new slot before their old slot is overwritten (each element stays
+// visible in one of its buckets) define copy_before_clear = true
+template <class DisStrat, class = void>
+struct is_copy_before_clear : std::false_type
+{
+};
+
+template <class DisStrat>
+struct is_copy_before_clear<DisStrat,
+                            std::enable_if_t<DisStrat::copy_before_clear>>
+    : std::true_type
+{
+};
+
+// concurrency policy of cuckoo tables: versions_none does not allow
+// concurrent accesses; bucket_versions keeps a version counter (seqlock)
+// per bucket, buckets are mapped to Stripes counters by their address.
+// The single writer increments the counter of a bucket before and after
+// it changes the bucket, thus, find_concurrent can run without locks
+// concurrently with this writer (retrying when a version changed)
+struct versions_none
+{
+    static constexpr bool enabled = false;
+    template <class B> void lock(const B*) {}
+    template <class B> void unlock(const B*) {}
+};
+
+template <size_t Stripes = 4096>
+class bucket_versions
+{
+  public:
+    static constexpr bool enabled = true;
+    static_assert((Stripes & (Stripes - 1)) == 0,
+                  "the number of version stripes has to be a power of 2");
+
+    bucket_versions()
+        : counters(std::make_unique<std::atomic<uint32_t>[]>(Stripes))
+    {
+    }
+
+    // writer side (odd versions mark buckets that are changed)
+    template <class B> void lock(const B* b)
+    {
+        auto& c = counter(b);
+        c.store(c.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    template <class B> void unlock(const B* b)
+    {
+        auto& c = counter(b);
+        c.store(c.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+    }
+
+    // reader side, a bucket read is valid if its version did not change
+    template <class B> uint32_t read_begin(const B* b) const
+    {
+        auto&    c = counter(b);
+        uint32_t v;
+        while ((v = c.load(std::memory_order_acquire)) & 1) _mm_pause();
+        return v;
+    }
+    template <class B> bool read_validate(const B* b, uint32_t v) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return counter(b).load(std::memory_order_relaxed) == v;
+    }
+
+  private:
+    std::unique_ptr<std::atomic<uint32_t>[]> counters;
+
+    template <class B> std::atomic<uint32_t>& counter(const B* b) const
+    {
+        return counters[(reinterpret_cast<uintptr_t>(b) / sizeof(B)) &
+                        (Stripes - 1)];
+    }
+};
+
+// growth policy of cuckoo_dysect: each growth event doubles Step
+// subtables; shrink thresholds are lowered by Hysteresis percent (less
+// grow/shrink thrash on oscillating sizes); the table does not grow
+// beyond MaxBytes (0 = unlimited), instead it reports memory pressure
+// and insertions that cannot be placed fail
+template <size_t Step = 1, size_t Hysteresis = 0, size_t MaxBytes = 0>
+struct dysect_growth
+{
+    static constexpr size_t step = Step;
+    static_assert(Step >= 1, "each growth event has to grow a subtable");
+    static_assert(Hysteresis < 100, "hysteresis is given in percent");
+
+    // grow once the elements do not fit the capacity after the next
+    // growth event (next slots) w.r.t. the size constraint
+    static size_t grow_thresh(size_t capacity, size_t next, double alpha)
+    {
+        return std::ceil((capacity + next) / alpha);
+    }
+    static size_t shrink_thresh(size_t capacity, size_t prev, double alpha)
+    {
+        return std::ceil((capacity - prev) / alpha * (100 - Hysteresis) /
+                         100.);
+    }
+    static bool may_grow(size_t bytes) { return !MaxBytes || bytes <= MaxBytes; }
+};
+
 template <size_t BS                       = 8,
           size_t NH                       = 3,
           size_t TL                       = 256,
           template <class> class DisStrat = cuckoo_displacement::bfs,
           bool FixErrors                  = true,
-          class History                   = history_none>
+          class History                   = history_none,
+          class Growth                    = dysect_growth<>,
+          class Versions                  = versions_none>
 struct cuckoo_config
 {
     static constexpr size_t bs         = BS;
@@ -88,7 +250,9 @@ struct cuckoo_config
     template <class T>
     using dis_strat_type = DisStrat<T>;
 
-    using history_type = History;
+    using history_type  = History;
+    using growth_type   = Growth;
+    using versions_type = Versions;
 };
 
 
@@ -105,6 +269,8 @@ class cuckoo_base
         SCuckoo>::config_type::template dis_strat_type<this_type>;
     using history_type =
         typename cuckoo_traits<SCuckoo>::config_type::history_type;
+    using versions_type =
+        typename cuckoo_traits<SCuckoo>::config_type::versions_type;
     using bucket_type = typename cuckoo_traits<SCuckoo>::bucket_type;
     using hasher_type = typename cuckoo_traits<SCuckoo>::hasher_type;
     using hashed_type = typename hasher_type::hashed_type;
@@ -115,7 +281,8 @@ class cuckoo_base
   public:
     using key_type       = typename cuckoo_traits<SCuckoo>::key_type;
     using mapped_type    = typename cuckoo_traits<SCuckoo>::mapped_type;
-    using value_type     = std::pair<const key_type, mapped_type>;
+    using value_type =
+        typename element_traits<key_type, mapped_type>::value_table;
     using iterator       = iterator_base<iterator_incr<specialized_type> >;
     using const_iterator = iterator_base<iterator_incr<specialized_type>, true>;
     using size_type      = size_t;
@@ -134,7 +301,8 @@ class cuckoo_base
     using node_type            = void;
 
   private:
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
   public:
     cuckoo_base(double    size_constraint = 1.1,
@@ -150,6 +318,7 @@ class cuckoo_base
         capacity    = rhs.capacity;
         grow_thresh = rhs.grow_thresh;
         alpha       = rhs.alpha;
+        hasher      = rhs.hasher;
         return *this;
     }
 
@@ -166,6 +335,7 @@ class cuckoo_base
     hasher_type                hasher;
     dis_strat_type             displacer;
     history_type               history;
+    versions_type              versions;
     static constexpr size_type bs = cuckoo_traits<specialized_type>::bs;
     static constexpr size_type tl = cuckoo_traits<specialized_type>::tl;
     static constexpr size_type nh = cuckoo_traits<specialized_type>::nh;
@@ -176,10 +346,61 @@ class cuckoo_base
     // Basic Hash Table Functionality ******************************************
     iterator           find(const key_type& k);
     const_iterator     find(const key_type& k) const;
-    insert_return_type insert(const key_type& k, const mapped_type& d);
+    // on sets (mapped_type void) elements are inserted with insert(k)
+    template <class M = mapped_type>
+    insert_return_type insert(const key_type& k, const enable_if_mapped<M, M>& d);
     insert_return_type insert(const value_intern& t);
     size_type          erase(const key_type& k);
     int                displacement(const key_type& k) const;
+    // erases k and returns its mapped data (one probe, not on sets)
+    template <class M = mapped_type>
+    std::pair<bool, enable_if_mapped<M, M> > pop(const key_type& k);
+
+    // Batched Insertions ******************************************************
+    // keys are hashed and their buckets are prefetched for a window of
+    // batch_window elements before any of them is placed, results (if
+    // given) stores for each element, whether it was newly inserted,
+    // returns the number of newly inserted elements
+    static constexpr size_type batch_window = 16;
+    size_type                  insert_batch(const value_intern* elements,
+                                            size_type           count,
+                                            bool*               results = nullptr);
+
+    // Batched Lookups *********************************************************
+    // the keys of each window are hashed together (hasher::hash_batch),
+    // and all their buckets are prefetched before the first one is
+    // scanned, results[i] points to the element with keys[i] (nullptr if
+    // it is not present), returns the number of found keys
+    size_type find_batch(const key_type* keys,
+                         size_type       count,
+                         value_type**    results);
+
+    // Concurrent Lookups (needs bucket_versions, not available on sets) ******
+    // can run without locks concurrently with one writer that inserts,
+    // erases, and updates (upsert, insert_or_assign) elements; versioned
+    // tables never reallocate buckets on their own (see auto_grow), the
+    // writer has to reserve the capacity (reserve_exclusive), insertions
+    // that find no free slot throw std::length_error (the table is not
+    // changed); reserve_exclusive, reserve, shrink_to_fit, clear, and
+    // explicit_grow must not run concurrently with readers
+    template <class M = mapped_type>
+    std::pair<bool, enable_if_mapped<M, M> >
+    find_concurrent(const key_type& k) const;
+
+    // Single Probe Updates (not available on sets) ****************************
+    // if k is present f(mapped) is applied in place, otherwise (k, init)
+    // is inserted; both cases use the same hash value and bucket scan;
+    // try_emplace constructs the mapped data only once k is known to be
+    // absent (i.e. after the scan)
+    template <class F, class M = mapped_type>
+    enable_if_mapped<M, insert_return_type>
+    upsert(const key_type& k, const enable_if_mapped<M, M>& init, F&& f);
+    template <class M = mapped_type, class... Args>
+    enable_if_mapped<M, insert_return_type>
+    try_emplace(const key_type& k, Args&&... args);
+    template <class M = mapped_type>
+    enable_if_mapped<M, insert_return_type>
+    insert_or_assign(const key_type& k, const enable_if_mapped<M, M>& d);
 
     // Easy use Accessors for std compliance ***********************************
     inline iterator       begin(); // see specialized_type
@@ -195,20 +416,45 @@ class cuckoo_base
     }
     inline const_iterator cend() const { return make_citerator(nullptr); }
 
-    mapped_type&       at(const key_type& k);
-    const mapped_type& at(const key_type& k) const;
-    mapped_type&       operator[](const key_type& k);
-    size_type          count(const key_type& k) const;
+    template <class M = mapped_type>
+    enable_if_mapped<M, M>& at(const key_type& k);
+    template <class M = mapped_type>
+    const enable_if_mapped<M, M>& at(const key_type& k) const;
+    template <class M = mapped_type>
+    enable_if_mapped<M, M>& operator[](const key_type& k);
+    size_type               count(const key_type& k) const;
 
     // Global fill state *******************************************************
     inline size_type empty() const { return (n == 0); }
     inline size_type size() const { return n; }
     inline size_type max_size() const { return (1ull << 32) * bs; }
 
-    inline void clear()
+    // Capacity ****************************************************************
+    // reserve(k) resizes the table for k elements (without intermediate
+    // growth events), shrink_to_fit() resizes it for the current elements
+    // (see resize), clear() removes all elements but keeps the capacity
+    // (lazy: the memory is returned to the kernel, see zero_memory.hpp)
+    inline void reserve(size_type k)
+    {
+        if (k > grow_thresh) static_cast<specialized_type*>(this)->resize(k);
+    }
+    // reserve for the writer of a versioned table (no readers may run),
+    // returns false if the growth policy did not allow k elements
+    inline bool reserve_exclusive(size_type k)
+    {
+        static_cast<specialized_type*>(this)->reserve(k);
+        return k <= grow_thresh && k <= capacity;
+    }
+    inline void shrink_to_fit()
     {
-        auto temp = specialized_type(0, alpha);
-        (*this)   = temp;
+        if (size_type(n * alpha) < capacity)
+            static_cast<specialized_type*>(this)->resize(n);
+    }
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        static_cast<specialized_type*>(this)->clear_buckets(mode);
+        n = 0;
+        history.clear();
     }
 
 
@@ -230,6 +476,33 @@ class cuckoo_base
     // implementation specific functions (static polymorph) ********************
     inline void inc_n() { ++n; }
     inline void dec_n() { --n; }
+    // replaces the hash functions, returns false if the table cannot
+    // rehash (then it grows instead)
+    inline bool rehash() { return false; }
+    // automatic growth (insertions beyond grow_thresh), tables with
+    // concurrent readers (bucket_versions) do not reallocate their
+    // buckets, they refuse to grow instead (see refuse_growth)
+    inline void auto_grow()
+    {
+        if constexpr (versions_type::enabled)
+            static_cast<specialized_type*>(this)->refuse_growth();
+        else
+            static_cast<specialized_type*>(this)->grow();
+    }
+    // insertions continue until the buckets are full, then they throw
+    // (cuckoo_dysect also reports memory pressure), reserve still grows
+    inline void refuse_growth() {}
+    // tables without a direct migration reach k with the usual growth
+    // events, they do not shrink
+    inline void resize(size_type k)
+    {
+        while (k > grow_thresh)
+        {
+            auto ocap = capacity;
+            static_cast<specialized_type*>(this)->grow();
+            if (capacity == ocap) break;
+        }
+    }
     inline void get_buckets(hashed_type h, bucket_type** mem) const
     {
         return static_cast<const specialized_type*>(this)->get_buckets(h, mem);
@@ -245,6 +518,24 @@ class cuckoo_base
 #endif
     }
 
+    // places t using precomputed buckets (probe, then displace), if
+    // t.first is present, *present is set to the bucket that holds it
+    insert_return_type insert_into(const value_intern& t,
+                                   hashed_type         hash,
+                                   bucket_type**       buckets,
+                                   bucket_type**       present = nullptr);
+    // insert_into for the element make() with key k, make is only called
+    // if k is not present
+    template <class Make>
+    insert_return_type emplace_into(const key_type& k,
+                                    hashed_type     hash,
+                                    bucket_type**   buckets,
+                                    Make&&          make,
+                                    bucket_type**   present);
+    // insert(t) that also returns the bucket of a present key (the
+    // versioned updates change the element under its version)
+    insert_return_type insert_at(const value_intern& t, bucket_type** present);
+
   public:
     // auxiliary functions for testing *****************************************
     void        clear_history();
@@ -271,12 +562,23 @@ cuckoo_base<SCuckoo>::cuckoo_base(double    size_constraint,
       alpha(size_constraint), displacer(*this, dis_steps, seed),
       history(dis_steps)
 {
+    static_assert(!versions_type::enabled ||
+                      is_copy_before_clear<dis_strat_type>::value,
+                  "concurrent readers need a displacement strategy that "
+                  "copies before it clears (cuckoo_displacement::bfs)");
+    static_assert(!versions_type::enabled || !fix_errors,
+                  "concurrent readers cannot run while a failed insertion "
+                  "grows the table (use FixErrors = false)");
+    static_assert(!versions_type::enabled ||
+                      !is_rehash_history<history_type>::value,
+                  "concurrent readers cannot run while the table rehashes");
 }
 
 template <class SCuckoo>
 cuckoo_base<SCuckoo>::cuckoo_base(cuckoo_base&& rhs)
-    : n(rhs.n), capacity(rhs.capacity), alpha(rhs.alpha),
-      displacer(*this, std::move(rhs.displacer))
+    : n(rhs.n), capacity(rhs.capacity), grow_thresh(rhs.grow_thresh),
+      alpha(rhs.alpha),
+      hasher(rhs.hasher), displacer(*this, std::move(rhs.displacer))
 {
 }
 
@@ -323,8 +625,9 @@ cuckoo_base<SCuckoo>::find(const key_type& k) const
 }
 
 template <class SCuckoo>
+template <class M>
 inline typename cuckoo_base<SCuckoo>::insert_return_type
-cuckoo_base<SCuckoo>::insert(const key_type& k, const mapped_type& d)
+cuckoo_base<SCuckoo>::insert(const key_type& k, const enable_if_mapped<M, M>& d)
 {
     return insert(std::make_pair(k, d));
 }
@@ -333,32 +636,74 @@ template <class SCuckoo>
 inline typename cuckoo_base<SCuckoo>::insert_return_type
 cuckoo_base<SCuckoo>::insert(const value_intern& t)
 {
-    if (n > grow_thresh) static_cast<specialized_type*>(this)->grow();
+    return insert_at(t, nullptr);
+}
+
+template <class SCuckoo>
+inline typename cuckoo_base<SCuckoo>::insert_return_type
+cuckoo_base<SCuckoo>::insert_at(const value_intern& t, bucket_type** present)
+{
+    if (n > grow_thresh) auto_grow();
     auto hash = hasher(t.first);
 
     bucket_type* buckets[nh];
     get_buckets(hash, buckets);
     prefetch_buckets(buckets);
 
-    std::pair<int, value_intern*> max = std::make_pair(0, nullptr);
+    return insert_into(t, hash, buckets, present);
+}
+
+template <class SCuckoo>
+inline typename cuckoo_base<SCuckoo>::insert_return_type
+cuckoo_base<SCuckoo>::insert_into(const value_intern& t,
+                                  hashed_type         hash,
+                                  bucket_type**       buckets,
+                                  bucket_type**       present)
+{
+    return emplace_into(
+        t.first, hash, buckets, [&t]() -> const value_intern& { return t; },
+        present);
+}
+
+template <class SCuckoo>
+template <class Make>
+inline typename cuckoo_base<SCuckoo>::insert_return_type
+cuckoo_base<SCuckoo>::emplace_into(const key_type& k,
+                                   hashed_type     hash,
+                                   bucket_type**   buckets,
+                                   Make&&          make,
+                                   bucket_type**   present)
+{
+    std::pair<int, value_intern*> max  = std::make_pair(0, nullptr);
+    bucket_type*                  maxb = nullptr;
     for (size_type i = 0; i < nh; ++i)
     {
-        // auto temp = get_bucket(hash, i)->probe_ptr(t.first);
-        auto temp = buckets[i]->probe_ptr(t.first);
+        // auto temp = get_bucket(hash, i)->probe_ptr(k);
+        auto temp = buckets[i]->probe_ptr(k);
 
         if (temp.first < 0)
+        {
+            if (present) *present = buckets[i];
             return std::make_pair(make_iterator(temp.second), false);
-        max = (max.first >= temp.first) ? max : temp;
+        }
+        if (max.first < temp.first)
+        {
+            max  = temp;
+            maxb = buckets[i];
+        }
     }
 
     if (max.first > 0)
     {
-        *max.second = t;
+        versions.lock(maxb);
+        *max.second = make();
+        versions.unlock(maxb);
         history.add(0);
         static_cast<specialized_type*>(this)->inc_n();
         return std::make_pair(make_iterator(max.second), true);
     }
 
+    auto&&        t     = make();
     int           srch  = -1;
     value_intern* pos   = nullptr;
     std::tie(srch, pos) = displacer.insert(t, hash);
@@ -369,14 +714,122 @@ cuckoo_base<SCuckoo>::insert(const value_intern& t)
         return std::make_pair(make_iterator(pos), true);
     }
 
+    if constexpr (is_rehash_history<history_type>::value)
+    {
+        history.fail();
+        if (history.rehash_needed())
+        {
+            history.clear();
+            if (static_cast<specialized_type*>(this)->rehash())
+                return insert(t);
+        }
+    }
     if constexpr (fix_errors)
     {
+        // the table can refuse to grow (see dysect_growth)
+        size_type tcap = capacity;
         explicit_grow();
-        return insert(t);
+        if (tcap != capacity) return insert(t);
     }
+    if constexpr (versions_type::enabled)
+        throw std::length_error("versioned cuckoo table is full "
+                                "(reserve_exclusive more elements)");
     return std::make_pair(end(), false);
 }
 
+template <class SCuckoo>
+inline typename cuckoo_base<SCuckoo>::size_type
+cuckoo_base<SCuckoo>::insert_batch(const value_intern* elements,
+                                   size_type           count,
+                                   bool*               results)
+{
+    size_type    inserted = 0;
+    key_type     keys[batch_window];
+    hashed_type  hashes[batch_window];
+    bucket_type* buckets[batch_window][nh];
+
+    // grow at most once for the whole batch (reserve for all elements
+    // that would overshoot grow_thresh), present keys are counted too
+    if (count && n + count - 1 > grow_thresh)
+    {
+        if constexpr (versions_type::enabled) auto_grow();
+        else static_cast<specialized_type*>(this)->reserve(n + count);
+    }
+
+    for (size_type w = 0; w < count; w += batch_window)
+    {
+        size_type           wn     = std::min(batch_window, count - w);
+        const value_intern* window = elements + w;
+
+        // safety net (e.g. if reserve was limited by the growth policy),
+        // growing before the window keeps the precomputed buckets valid
+        if (n + wn - 1 > grow_thresh) auto_grow();
+
+        for (size_type i = 0; i < wn; ++i) keys[i] = window[i].first;
+        hasher.hash_batch(keys, wn, hashes);
+
+        for (size_type i = 0; i < wn; ++i)
+        {
+            get_buckets(hashes[i], buckets[i]);
+            for (size_type j = 0; j < nh; ++j)
+                __builtin_prefetch(buckets[i][j], 1);
+        }
+
+        for (size_type i = 0; i < wn; ++i)
+        {
+            size_type tcap  = capacity;
+            uint64_t  tseed = hasher.seed();
+            auto      r     = insert_into(window[i], hashes[i], buckets[i]);
+            inserted += (r.second) ? 1 : 0;
+            if (results) results[w + i] = r.second;
+
+            // a failed displacement grew the table (see fix_errors) or
+            // replaced the hash functions (see rehash)
+            if (tseed != hasher.seed())
+                hasher.hash_batch(keys + i + 1, wn - i - 1, hashes + i + 1);
+            if (tcap != capacity || tseed != hasher.seed())
+                for (size_type j = i + 1; j < wn; ++j)
+                    get_buckets(hashes[j], buckets[j]);
+        }
+    }
+    return inserted;
+}
+
+template <class SCuckoo>
+inline typename cuckoo_base<SCuckoo>::size_type
+cuckoo_base<SCuckoo>::find_batch(const key_type* keys,
+                                 size_type       count,
+                                 value_type**    results)
+{
+    size_type    found = 0;
+    hashed_type  hashes[batch_window];
+    bucket_type* buckets[batch_window][nh];
+
+    for (size_type w = 0; w < count; w += batch_window)
+    {
+        size_type       wn     = std::min(batch_window, count - w);
+        const key_type* window = keys + w;
+
+        hasher.hash_batch(window, wn, hashes);
+        for (size_type i = 0; i < wn; ++i)
+        {
+            get_buckets(hashes[i], buckets[i]);
+            for (size_type j = 0; j < nh; ++j)
+                __builtin_prefetch(buckets[i][j]);
+        }
+
+        for (size_type i = 0; i < wn; ++i)
+        {
+            value_intern* tp = nullptr;
+            for (size_type j = 0; j < nh && !tp; ++j)
+                tp = buckets[i][j]->find_ptr(window[i]);
+            results[w + i] = reinterpret_cast<value_type*>(tp);
+            found += (tp) ? 1 : 0;
+        }
+    }
+    return found;
+}
+
 template <class SCuckoo>
 inline typename cuckoo_base<SCuckoo>::size_type
 cuckoo_base<SCuckoo>::erase(const key_type& k)
@@ -391,7 +844,10 @@ cuckoo_base<SCuckoo>::erase(const key_type& k)
     {
 
         // bucket_type* tb = get_bucket(hash, i);
-        if (buckets[i]->remove(k))
+        versions.lock(buckets[i]);
+        bool removed = buckets[i]->remove(k);
+        versions.unlock(buckets[i]);
+        if (removed)
         {
             static_cast<specialized_type*>(this)->dec_n();
             return 1;
@@ -400,6 +856,31 @@ cuckoo_base<SCuckoo>::erase(const key_type& k)
     return 0;
 }
 
+template <class SCuckoo>
+template <class M>
+inline std::pair<bool, enable_if_mapped<M, M> >
+cuckoo_base<SCuckoo>::pop(const key_type& k)
+{
+    auto hash = hasher(k);
+
+    bucket_type* buckets[nh];
+    get_buckets(hash, buckets);
+    prefetch_buckets(buckets);
+
+    for (size_type i = 0; i < nh; ++i)
+    {
+        versions.lock(buckets[i]);
+        auto result = buckets[i]->pop(k);
+        versions.unlock(buckets[i]);
+        if (result.first)
+        {
+            static_cast<specialized_type*>(this)->dec_n();
+            return result;
+        }
+    }
+    return std::make_pair(false, mapped_type());
+}
+
 template <class SCuckoo>
 inline int cuckoo_base<SCuckoo>::displacement(const key_type& k) const
 {
@@ -420,11 +901,114 @@ inline int cuckoo_base<SCuckoo>::displacement(const key_type& k) const
     return -1;
 }
 
+// Concurrent Lookups **********************************************************
+// the versions of all buckets are read before any of them is scanned,
+// thus, a valid read sees all buckets of k in the same state, and since
+// displacements copy before they clear, k is in one of them
+
+template <class SCuckoo>
+template <class M>
+inline std::pair<bool, enable_if_mapped<M, M> >
+cuckoo_base<SCuckoo>::find_concurrent(const key_type& k) const
+{
+    static_assert(versions_type::enabled,
+                  "find_concurrent needs bucket_versions (see cuckoo_config)");
+    auto hash = hasher(k);
+
+    bucket_type* buckets[nh];
+    get_buckets(hash, buckets);
+    prefetch_buckets(buckets);
+
+    while (true)
+    {
+        uint32_t v[nh];
+        for (size_type i = 0; i < nh; ++i)
+            v[i] = versions.read_begin(buckets[i]);
+
+        auto result = std::make_pair(false, mapped_type());
+        for (size_type i = 0; i < nh && !result.first; ++i)
+            result = buckets[i]->find_relaxed(k);
+
+        bool valid = true;
+        for (size_type i = 0; i < nh; ++i)
+            valid &= versions.read_validate(buckets[i], v[i]);
+        if (valid) return result;
+    }
+}
+
+// Single Probe Updates ********************************************************
+// insert already returns the position of a present key (without any
+// displacement), therefore, updates go through the specialized insert;
+// versioned tables use insert_at, it also returns the bucket of the key;
+// try_emplace probes like insert_at, but the element is only constructed
+// once its key is known to be absent
+
+template <class SCuckoo>
+template <class F, class M>
+inline enable_if_mapped<M, typename cuckoo_base<SCuckoo>::insert_return_type>
+cuckoo_base<SCuckoo>::upsert(const key_type& k,
+                             const enable_if_mapped<M, M>& init,
+                             F&& f)
+{
+    bucket_type* b = nullptr;
+    auto         r = (versions_type::enabled)
+                         ? insert_at(std::make_pair(k, init), &b)
+                         : static_cast<specialized_type*>(this)->insert(k, init);
+    if (!r.second && r.first != end())
+    {
+        versions.lock(b);
+        f((*r.first).second);
+        versions.unlock(b);
+    }
+    return r;
+}
+
+template <class SCuckoo>
+template <class M, class... Args>
+inline enable_if_mapped<M, typename cuckoo_base<SCuckoo>::insert_return_type>
+cuckoo_base<SCuckoo>::try_emplace(const key_type& k, Args&&... args)
+{
+    if (n > grow_thresh) auto_grow();
+    auto hash = hasher(k);
+
+    bucket_type* buckets[nh];
+    get_buckets(hash, buckets);
+    prefetch_buckets(buckets);
+
+    return emplace_into(
+        k, hash, buckets,
+        [&]() {
+            return value_intern(k, mapped_type(std::forward<Args>(args)...));
+        },
+        nullptr);
+}
+
+template <class SCuckoo>
+template <class M>
+inline enable_if_mapped<M, typename cuckoo_base<SCuckoo>::insert_return_type>
+cuckoo_base<SCuckoo>::insert_or_assign(const key_type& k,
+                                       const enable_if_mapped<M, M>& d)
+{
+    bucket_type* b = nullptr;
+    auto         r = (versions_type::enabled)
+                         ? insert_at(std::make_pair(k, d), &b)
+                         : static_cast<specialized_type*>(this)->insert(k, d);
+    if (!r.second && r.first != end())
+    {
+        versions.lock(b);
+        (*r.first).second = d;
+        versions.unlock(b);
+    }
+    return r;
+}
+
+
+
 // Accessor Implementations ****************************************************
 
 template <class SCuckoo>
-inline typename cuckoo_base<SCuckoo>::mapped_type&
-cuckoo_base<SCuckoo>::at(const key_type& k)
+template <class M>
+inline enable_if_mapped<M, M>& cuckoo_base<SCuckoo>::at(const key_type& k)
 {
     auto a = static_cast<specialized_type*>(this)->find(k);
     if (a == end())
@@ -434,7 +1018,8 @@ cuckoo_base<SCuckoo>::at(const key_type& k)
 }
 
 template <class SCuckoo>
-inline const typename cuckoo_base<SCuckoo>::mapped_type&
+template <class M>
+inline const enable_if_mapped<M, M>&
 cuckoo_base<SCuckoo>::at(const key_type& k) const
 {
     auto a = static_cast<const specialized_type*>(this)->find(k);
@@ -445,7 +1030,8 @@ cuckoo_base<SCuckoo>::at(const key_type& k) const
 }
 
 template <class SCuckoo>
-inline typename cuckoo_base<SCuckoo>::mapped_type&
+template <class M>
+inline enable_if_mapped<M, M>&
 cuckoo_base<SCuckoo>::operator[](const key_type& k)
 {
     auto t = static_cast<specialized_type*>(this)->insert(k, mapped_type());
@@ -151,6 +151,11 @@ class cuckoo_deamortized
 
 
 
+    inline void clear_buckets(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+    }
+
     // Size changes (GROWING) **************************************************
 
     inline void grow()
@@ -19,6 +19,10 @@
  * of memory).  This can be more efficient since offsets can be
  * computed more quickly.
  *
+ * Both variants can place their subtables on NUMA nodes
+ * (place_subtables), node_of_key returns the node that holds the first
+ * choice subtable of a key.
+ *
  * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
  *
  * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
@@ -27,6 +31,9 @@
  ******************************************************************************/
 
 #include "cuckoo_base.hpp"
+#include "indirect_table.hpp"
+#include "numa_placement.hpp"
+#include "string_table.hpp"
 #include "utils/default_hash.hpp"
 #include <cmath>
 
@@ -57,11 +64,18 @@ class cuckoo_dysect
     using const_iterator = typename base_type::const_iterator;
     using size_type      = typename base_type::size_type;
 
+  private:
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
+
+  public:
 
     cuckoo_dysect(size_type cap = 0, double size_constraint = 1.1,
                   size_type dis_steps = 256, size_type seed = 0)
         : base_type(size_constraint, dis_steps, seed)
     {
+        std::fill(subtable_node, subtable_node + tl, -1);
+
         double avg_size_f = double(cap) * size_constraint / double(tl * bs);
 
         size_type size_small = 1;
@@ -93,7 +107,8 @@ class cuckoo_dysect
             bits_large = (bits_large << 1) + 1;
         }
 
-        grow_thresh  = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
+        grow_thresh  = growth_type::grow_thresh(
+            capacity, growth_type::step * (bits_large + 1) * bs, alpha);
         shrnk_thresh = 0; // ensures no shrinking until grown at least once
     }
 
@@ -103,12 +118,13 @@ class cuckoo_dysect
     cuckoo_dysect(cuckoo_dysect&& rhs)
         : base_type(std::move(rhs)), n_large(rhs.n_large),
           bits_small(rhs.bits_small), bits_large(rhs.bits_large),
-          shrnk_thresh(rhs.shrnk_thresh)
+          shrnk_thresh(rhs.shrnk_thresh), pressure(rhs.pressure)
     {
         for (size_type i = 0; i < tl; ++i)
         {
             // llb[i] = rhs.llb[i];
-            llt[i] = std::move(rhs.llt[i]);
+            llt[i]           = std::move(rhs.llt[i]);
+            subtable_node[i] = rhs.subtable_node[i];
         }
     }
 
@@ -119,8 +135,13 @@ class cuckoo_dysect
         std::swap(bits_small, rhs.bits_small);
         std::swap(bits_large, rhs.bits_large);
         std::swap(shrnk_thresh, rhs.shrnk_thresh);
+        std::swap(pressure, rhs.pressure);
 
-        for (size_type i = 0; i < tl; ++i) { std::swap(llt[i], rhs.llt[i]); }
+        for (size_type i = 0; i < tl; ++i)
+        {
+            std::swap(llt[i], rhs.llt[i]);
+            std::swap(subtable_node[i], rhs.subtable_node[i]);
+        }
         return *this;
     }
 
@@ -135,12 +156,17 @@ class cuckoo_dysect
     static constexpr size_type tl = cuckoo_traits<this_type>::tl;
     static constexpr size_type nh = cuckoo_traits<this_type>::nh;
 
+    using growth_type   = typename Conf::growth_type;
+    using versions_type = typename Conf::versions_type;
+
     size_type n_large;
     size_type bits_small;
     size_type bits_large;
     size_type shrnk_thresh;
+    bool      pressure = false;
 
     std::unique_ptr<bucket_type[]> llt[tl];
+    int                            subtable_node[tl]; // -1 default placement
 
     static constexpr size_type tl_bitmask = tl - 1;
 
@@ -151,17 +177,45 @@ class cuckoo_dysect
     iterator begin()
     {
         auto temp = make_iterator(&llt[0][0].elements[0]);
-        if (!temp->first) temp++;
+        if (!llt[0][0].elements[0].first) temp++;
         return temp;
     }
 
     const_iterator cbegin() const
     {
         auto temp = make_citerator(&llt[0][0].elements[0]);
-        if (!temp->first) temp++;
+        if (!llt[0][0].elements[0].first) temp++;
         return temp;
     }
 
+    // the growth policy refused to grow (see dysect_growth), or a table
+    // with bucket_versions reached its reserved capacity (refuse_growth)
+    bool memory_pressure() const { return pressure; }
+
+    // NUMA placement **********************************************************
+    // subtable i is moved to nodes[i % nodes.size()], migrations allocate
+    // the new subtable on the same node (see numa_placement.hpp)
+    void place_subtables(const std::vector<int>& nodes)
+    {
+        if (nodes.empty()) return;
+        for (size_type t = 0; t < tl; ++t)
+        {
+            subtable_node[t] = nodes[t % nodes.size()];
+            numa_bind(llt[t].get(), (bitmask(t) + 1) * sizeof(bucket_type),
+                      subtable_node[t]);
+        }
+    }
+    // round robin over all online nodes
+    void place_subtables() { place_subtables(numa_online_nodes()); }
+
+    int node_of_subtable(size_type tab) const { return subtable_node[tab]; }
+    // node of the first choice subtable of k (-1 if it was not placed),
+    // e.g., to route requests for k to a thread on that node
+    int node_of_key(const key_type& k) const
+    {
+        return subtable_node[ext::tab(hasher(k), 0)];
+    }
+
   private:
     // Functions for finding buckets *******************************************
 
@@ -170,6 +224,19 @@ class cuckoo_dysect
         return (tab < n_large) ? bits_large : bits_small;
     }
 
+    // new subtables are allocated on their node only if the buckets are
+    // trivially destructible (numa_make_array could not release them otherwise)
+    inline std::unique_ptr<bucket_type[]> make_subtable(size_type tab,
+                                                        size_type size) const
+    {
+        if constexpr (std::is_trivially_destructible_v<bucket_type>)
+        {
+            if (subtable_node[tab] >= 0)
+                return numa_make_array<bucket_type>(size, subtable_node[tab]);
+        }
+        return std::make_unique<bucket_type[]>(size);
+    }
+
     inline void get_buckets(hashed_type h, bucket_type** mem) const
     {
         for (size_type i = 0; i < nh; ++i) mem[i] = get_bucket(h, i);
@@ -186,9 +253,31 @@ class cuckoo_dysect
 
     // Size changes (GROWING) **************************************************
 
+    // one growth event doubles growth_type::step subtables
     inline void grow()
     {
-        auto ntab = std::make_unique<bucket_type[]>(bits_large + 1);
+        for (size_type i = 0; i < growth_type::step; ++i)
+        {
+            size_type bytes =
+                (capacity / bs + bits_small + 1) * sizeof(bucket_type);
+            if (!growth_type::may_grow(bytes))
+            {
+                pressure = true;
+                break;
+            }
+            grow_subtable();
+        }
+        set_thresholds();
+        if (pressure) grow_thresh = std::numeric_limits<size_type>::max();
+    }
+
+    // versioned tables do not grow automatically (see
+    // cuckoo_base::auto_grow), this is reported as memory pressure
+    inline void refuse_growth() { pressure = true; }
+
+    inline void grow_subtable()
+    {
+        auto ntab = make_subtable(n_large, bits_large + 1);
         migrate_grw(n_large, ntab);
 
         llt[n_large] = std::move(ntab);
@@ -200,8 +289,115 @@ class cuckoo_dysect
             bits_small = bits_large;
             bits_large = (bits_large << 1) + 1;
         }
-        grow_thresh  = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
-        shrnk_thresh = std::ceil((capacity - (bits_large + 1) * bs) / alpha);
+    }
+
+    inline void set_thresholds()
+    {
+        grow_thresh  = growth_type::grow_thresh(
+            capacity, growth_type::step * (bits_large + 1) * bs, alpha);
+        shrnk_thresh = growth_type::shrink_thresh(
+            capacity, (bits_large + 1) * bs, alpha);
+    }
+
+    // reserve: the subtables are grown in the order of growth events
+    // until k elements fit, but each subtable is migrated only once (to
+    // its final size); shrink_to_fit: subtables are shrunk while k fits
+    inline void resize(size_type k)
+    {
+        if (k <= grow_thresh)
+        {
+            while ((n_large || bits_small) &&
+                   k * alpha <= capacity - shrink_step())
+                shrink();
+            return;
+        }
+
+        // a refused growth (see refuse_growth) is resolved by this
+        pressure = false;
+
+        size_type nl   = n_large;
+        size_type bsml = bits_small;
+        size_type blrg = bits_large;
+        size_type cap  = capacity;
+        size_type nbits[tl];
+        for (size_type t = 0; t < tl; ++t) nbits[t] = bitmask(t);
+
+        while (k > growth_type::grow_thresh(
+                       cap, growth_type::step * (blrg + 1) * bs, alpha))
+        {
+            size_type bytes = (cap / bs + bsml + 1) * sizeof(bucket_type);
+            if (!growth_type::may_grow(bytes))
+            {
+                pressure = true;
+                break;
+            }
+            nbits[nl] = blrg;
+            cap += (bsml + 1) * bs;
+            if (++nl == tl)
+            {
+                nl   = 0;
+                bsml = blrg;
+                blrg = (blrg << 1) + 1;
+            }
+        }
+
+        for (size_type t = 0; t < tl; ++t)
+        {
+            if (nbits[t] == bitmask(t)) continue;
+            auto ntab = make_subtable(t, nbits[t] + 1);
+            migrate_to(t, nbits[t], ntab);
+            llt[t] = std::move(ntab);
+        }
+
+        n_large    = nl;
+        bits_small = bsml;
+        bits_large = blrg;
+        capacity   = cap;
+        set_thresholds();
+        if (pressure) grow_thresh = std::numeric_limits<size_type>::max();
+    }
+
+    // moves subtable tab into target (nbits + 1 buckets, a multiple of its
+    // current size), each bucket is split into the buckets that share its
+    // lower bits, thus no bucket can overflow
+    inline void migrate_to(size_type tab, size_type nbits,
+                           std::unique_ptr<bucket_type[]>& target)
+    {
+        size_type obits = bitmask(tab);
+
+        for (size_type i = 0; i <= obits; ++i)
+        {
+            bucket_type* curr = &(llt[tab][i]);
+
+            for (size_type j = 0; j < bs; ++j)
+            {
+                auto e = curr->elements[j];
+                if (!e.first) break;
+                auto hash = hasher(e.first);
+
+                for (size_type ti = 0; ti < nh; ++ti)
+                {
+                    size_type loc = ext::loc(hash, ti);
+                    if (ext::tab(hash, ti) == tab && (loc & obits) == i)
+                    {
+                        target[loc & nbits].insert(e);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // capacity that is removed by the next shrink
+    inline size_type shrink_step() const
+    {
+        return ((n_large) ? bits_small + 1 : (bits_small + 1) >> 1) * bs;
+    }
+
+    inline void clear_buckets(clear_mode mode)
+    {
+        for (size_type t = 0; t < tl; ++t)
+            zero_range(llt[t].get(), llt[t].get() + bitmask(t) + 1, mode);
     }
 
     inline void
@@ -242,12 +438,72 @@ class cuckoo_dysect
 
 
 
+    // Rehashing (see history_rehash) *****************************************
+    // new hash functions, the table is rebuilt one subtable at a time
+    // (only its elements are buffered); elements of later subtables can
+    // be displaced into their new buckets before their subtable is
+    // reached, elements that cannot be placed are inserted at the end
+    // (this can grow the table)
+    inline bool rehash()
+    {
+        hasher = hasher.next_seed();
+
+        std::vector<value_intern> buffer;
+        std::vector<value_intern> failed;
+        for (size_type t = 0; t < tl; ++t)
+        {
+            for (size_type i = 0; i <= bitmask(t); ++i)
+            {
+                bucket_type& b = llt[t][i];
+                for (size_type j = 0; j < bs && b.elements[j].first; ++j)
+                    buffer.push_back(b.elements[j]);
+                b = bucket_type();
+            }
+            for (auto& e : buffer)
+                if (!place(e)) failed.push_back(e);
+            buffer.clear();
+        }
+
+        n -= failed.size();
+        for (auto& e : failed) base_type::insert(e);
+        return true;
+    }
+
+    // places an element that is already counted in n (no growing)
+    inline bool place(const value_intern& e)
+    {
+        auto         hash = hasher(e.first);
+        bucket_type* b[nh];
+        get_buckets(hash, b);
+
+        // bucket with the most free slots (like cuckoo_base::insert_into)
+        std::pair<int, value_intern*> max = std::make_pair(0, nullptr);
+        for (size_type i = 0; i < nh; ++i)
+        {
+            auto temp = b[i]->probe_ptr(e.first);
+            max       = (max.first >= temp.first) ? max : temp;
+        }
+        if (max.first > 0)
+        {
+            *max.second = e;
+            return true;
+        }
+        return base_type::displacer.insert(e, hash).first >= 0;
+    }
+
+
+
     // Size changes (SHRINKING) ************************************************
 
+    // versioned tables do not shrink (concurrent readers, see
+    // cuckoo_base::find_concurrent)
     inline void dec_n()
     {
         --n;
-        if (n < shrnk_thresh) shrink();
+        if constexpr (!versions_type::enabled)
+        {
+            if (n < shrnk_thresh) shrink();
+        }
     }
 
     inline void shrink()
@@ -259,8 +515,8 @@ class cuckoo_dysect
             bits_small >>= 1;
             bits_large >>= 1;
         }
-        auto ntab = std::make_unique<bucket_type[]>(bits_small + 1);
-        std::vector<std::pair<key_type, mapped_type> > buffer;
+        auto ntab = make_subtable(n_large, bits_small + 1);
+        std::vector<value_intern> buffer;
 
         migrate_shrnk(n_large, ntab, buffer);
 
@@ -269,14 +525,14 @@ class cuckoo_dysect
         finish_shrnk(buffer);
 
         capacity -= (bits_small + 1) * bs;
-        grow_thresh  = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
-        shrnk_thresh = std::ceil((capacity - (bits_large + 1) * bs) / alpha);
+        pressure = false;
+        set_thresholds();
         if (bits_small == 0 && !n_large) shrnk_thresh = 0;
     }
 
     inline void
     migrate_shrnk(size_type tab, std::unique_ptr<bucket_type[]>& target,
-                  std::vector<std::pair<key_type, mapped_type> >& buffer)
+                  std::vector<value_intern>& buffer)
     {
         size_type flag = bits_small + 1;
 
@@ -329,7 +585,7 @@ class cuckoo_dysect
     }
 
     inline void
-    finish_shrnk(std::vector<std::pair<key_type, mapped_type> >& buffer)
+    finish_shrnk(std::vector<value_intern>& buffer)
     {
         size_type err = 0;
         n -= buffer.size();
@@ -373,7 +629,7 @@ class iterator_incr<cuckoo_dysect<K, D, HF, Conf> >
 
   private:
     using size_type               = typename table_type::size_type;
-    using ipointer                = std::pair<const K, D>*;
+    using ipointer                = typename element_traits<K, D>::value_table*;
     static constexpr size_type tl = Conf::tl;
     static constexpr size_type bs = Conf::bs;
 
@@ -396,9 +652,14 @@ class iterator_incr<cuckoo_dysect<K, D, HF, Conf> >
             if (!temp) return nullptr;
         }
 
-        while (!temp->first)
+        while (!element_traits<K, D>::key(*temp))
         {
-            if (++temp > end_tab) return overflow_tab();
+            // the first slot of the next subtable can be empty too
+            if (++temp > end_tab)
+            {
+                temp = overflow_tab();
+                if (!temp) return nullptr;
+            }
         }
         return temp;
     }
@@ -485,7 +746,8 @@ class cuckoo_dysect_inplace
     using size_type      = typename base_type::size_type;
 
   private:
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
     static constexpr size_type bs = cuckoo_traits<this_type>::bs;
     static constexpr size_type tl = cuckoo_traits<this_type>::tl;
@@ -503,6 +765,7 @@ class cuckoo_dysect_inplace
         // auto temp = operator new (max_size);
         auto temp = static_cast<bucket_type*>(aligned_alloc(4096, max_size));
         table     = std::unique_ptr<bucket_type[]>(temp);
+        std::fill(subtable_node, subtable_node + tl, -1);
 
         double avg_size_f = double(cap) * size_constraint / double(tl * bs);
 
@@ -539,7 +802,8 @@ class cuckoo_dysect_inplace
             bits_large = (bits_large << 1) + 1;
         }
 
-        grow_thresh  = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
+        grow_thresh  = growth_type::grow_thresh(
+            capacity, growth_type::step * (bits_large + 1) * bs, alpha);
         shrnk_thresh = 0; // ensures no shrinking until grown at least once
     }
 
@@ -556,14 +820,18 @@ class cuckoo_dysect_inplace
     using base_type::hasher;
     using base_type::n;
 
+    using growth_type = typename Conf::growth_type;
+
     size_type n_large;
     size_type bits_small;
     size_type bits_large;
     size_type shrnk_thresh;
+    bool      pressure = false;
 
     // std::unique_ptr<bucket_type[]> memory;
     // bucket_type* table;
     std::unique_ptr<bucket_type[]> table;
+    int                            subtable_node[tl]; // -1 default placement
 
     static constexpr size_type tl_bitmask = tl - 1;
 
@@ -574,17 +842,40 @@ class cuckoo_dysect_inplace
     iterator begin()
     {
         auto temp = make_iterator(&table[0].elements[0]);
-        if (!temp->first) temp++;
+        if (!table[0].elements[0].first) temp++;
         return temp;
     }
 
     const_iterator cbegin() const
     {
         auto temp = make_citerator(&table[0].elements[0]);
-        if (!temp->first) temp++;
+        if (!table[0].elements[0].first) temp++;
         return temp;
     }
 
+    bool memory_pressure() const { return pressure; }
+
+    // NUMA placement **********************************************************
+    // see cuckoo_dysect::place_subtables, the whole (overallocated) region
+    // of each subtable is bound, thus, in place growth stays on the node
+    void place_subtables(const std::vector<int>& nodes)
+    {
+        if (nodes.empty()) return;
+        for (size_type t = 0; t < tl; ++t)
+        {
+            subtable_node[t] = nodes[t % nodes.size()];
+            numa_bind(table_off(t), max_loc_size * sizeof(bucket_type),
+                      subtable_node[t]);
+        }
+    }
+    void place_subtables() { place_subtables(numa_online_nodes()); }
+
+    int node_of_subtable(size_type tab) const { return subtable_node[tab]; }
+    int node_of_key(const key_type& k) const
+    {
+        return subtable_node[ext::tab(hasher(k), 0)];
+    }
+
   private:
     // Functions for finding buckets *******************************************
 
@@ -612,7 +903,137 @@ class cuckoo_dysect_inplace
 
     // Size changes (GROWING) **************************************************
 
+    // see cuckoo_dysect::grow
     void grow()
+    {
+        for (size_type i = 0; i < growth_type::step; ++i)
+        {
+            size_type bytes =
+                (capacity / bs + bits_small + 1) * sizeof(bucket_type);
+            if (!growth_type::may_grow(bytes))
+            {
+                pressure = true;
+                break;
+            }
+            grow_subtable();
+        }
+        set_thresholds();
+        if (pressure) grow_thresh = std::numeric_limits<size_type>::max();
+    }
+
+    // see cuckoo_dysect::refuse_growth
+    void refuse_growth() { pressure = true; }
+
+    void set_thresholds()
+    {
+        grow_thresh  = growth_type::grow_thresh(
+            capacity, growth_type::step * (bits_large + 1) * bs, alpha);
+        shrnk_thresh = growth_type::shrink_thresh(
+            capacity, (bits_large + 1) * bs, alpha);
+    }
+
+    // see cuckoo_dysect::resize, subtables are grown and shrunk in place
+    // (the table does not shrink automatically on erase)
+    void resize(size_type k)
+    {
+        if (k <= grow_thresh)
+        {
+            while ((n_large || bits_small) &&
+                   k * alpha <= capacity - shrink_step())
+                shrink();
+            return;
+        }
+
+        pressure = false; // see cuckoo_dysect::resize
+
+        size_type nl   = n_large;
+        size_type bsml = bits_small;
+        size_type blrg = bits_large;
+        size_type cap  = capacity;
+        size_type nbits[tl];
+        for (size_type t = 0; t < tl; ++t) nbits[t] = bitmask(t);
+
+        while (k > growth_type::grow_thresh(
+                       cap, growth_type::step * (blrg + 1) * bs, alpha))
+        {
+            size_type bytes = (cap / bs + bsml + 1) * sizeof(bucket_type);
+            if (!growth_type::may_grow(bytes) || blrg + 1 > max_loc_size)
+            {
+                pressure = true;
+                break;
+            }
+            nbits[nl] = blrg;
+            cap += (bsml + 1) * bs;
+            if (++nl == tl)
+            {
+                nl   = 0;
+                bsml = blrg;
+                blrg = (blrg << 1) + 1;
+            }
+        }
+
+        for (size_type t = 0; t < tl; ++t)
+        {
+            if (nbits[t] != bitmask(t)) migrate_to(t, nbits[t]);
+        }
+
+        n_large    = nl;
+        bits_small = bsml;
+        bits_large = blrg;
+        capacity   = cap;
+        set_thresholds();
+        if (pressure) grow_thresh = std::numeric_limits<size_type>::max();
+    }
+
+    // in place version of cuckoo_dysect::migrate_to, the elements of a
+    // bucket stay in it or move behind the old end of the subtable
+    void migrate_to(size_type tab, size_type nbits)
+    {
+        size_type    obits  = bitmask(tab);
+        bucket_type* offset = table_off(tab);
+        std::fill(offset + obits + 1, offset + nbits + 1, bucket_type());
+
+        for (size_type i = 0; i <= obits; ++i)
+        {
+            bucket_type curr = offset[i];
+            offset[i]        = bucket_type();
+
+            for (size_type j = 0; j < bs; ++j)
+            {
+                auto e = curr.elements[j];
+                if (!e.first) break;
+                auto hash = hasher(e.first);
+
+                for (size_type ti = 0; ti < nh; ++ti)
+                {
+                    size_type loc = ext::loc(hash, ti);
+                    if (ext::tab(hash, ti) == tab && (loc & obits) == i)
+                    {
+                        offset[loc & nbits].insert(e);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    size_type shrink_step() const
+    {
+        return ((n_large) ? bits_small + 1 : (bits_small + 1) >> 1) * bs;
+    }
+
+    // the pages of each subtable's region are dropped (lazy), thus they
+    // are not committed again until the subtable is refilled
+    void clear_buckets(clear_mode mode)
+    {
+        for (size_type t = 0; t < tl; ++t)
+        {
+            auto offset = table_off(t);
+            zero_range(offset, offset + bitmask(t) + 1, mode);
+        }
+    }
+
+    void grow_subtable()
     {
         // auto   ntab  = std::make_unique<bucket_type[]>( bits_large + 1 );
         bucket_type* offset = table_off(n_large);
@@ -630,8 +1051,6 @@ class cuckoo_dysect_inplace
             bits_small = bits_large;
             bits_large = (bits_large << 1) + 1;
         }
-        grow_thresh  = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
-        shrnk_thresh = std::ceil((capacity - (bits_large + 1) * bs) / alpha);
     }
 
     void migrate_grw(size_type tab)
@@ -674,6 +1093,55 @@ class cuckoo_dysect_inplace
 
 
 
+    // Rehashing (see history_rehash) *****************************************
+    // same as cuckoo_dysect::rehash
+    bool rehash()
+    {
+        hasher = hasher.next_seed();
+
+        std::vector<value_intern> buffer;
+        std::vector<value_intern> failed;
+        for (size_type t = 0; t < tl; ++t)
+        {
+            bucket_type* b = table_off(t);
+            for (size_type i = 0; i <= bitmask(t); ++i, ++b)
+            {
+                for (size_type j = 0; j < bs && b->elements[j].first; ++j)
+                    buffer.push_back(b->elements[j]);
+                *b = bucket_type();
+            }
+            for (auto& e : buffer)
+                if (!place(e)) failed.push_back(e);
+            buffer.clear();
+        }
+
+        n -= failed.size();
+        for (auto& e : failed) base_type::insert(e);
+        return true;
+    }
+
+    bool place(const value_intern& e)
+    {
+        auto         hash = hasher(e.first);
+        bucket_type* b[nh];
+        get_buckets(hash, b);
+
+        std::pair<int, value_intern*> max = std::make_pair(0, nullptr);
+        for (size_type i = 0; i < nh; ++i)
+        {
+            auto temp = b[i]->probe_ptr(e.first);
+            max       = (max.first >= temp.first) ? max : temp;
+        }
+        if (max.first > 0)
+        {
+            *max.second = e;
+            return true;
+        }
+        return base_type::displacer.insert(e, hash).first >= 0;
+    }
+
+
+
     // Size changes (SHRINKING) ************************************************
 
     // inline void dec_n()
@@ -682,89 +1150,41 @@ class cuckoo_dysect_inplace
     //     if (n < shrnk_thresh) shrink();
     // }
 
-    // inline void shrink()
-    // {
-    //     if (n_large) { n_large--; }
-    //     else         { n_large = tl-1; bits_small >>= 1; bits_large >>= 1; }
-    //     auto ntab = std::make_unique<bucket_type[]>(bits_small + 1);
-    //     std::vector<std::pair<key_type, mapped_type> > buffer;
-
-    //     migrate_shrnk( n_large, ntab, buffer );
-
-    //     llt[n_large] = std::move(ntab);
-
-    //     finish_shrnk(buffer);
+    // halves one subtable in place, bucket i + flag is merged into
+    // bucket i, elements that do not fit are inserted again
+    void shrink()
+    {
+        if (n_large) { n_large--; }
+        else
+        {
+            n_large = tl - 1;
+            bits_small >>= 1;
+            bits_large >>= 1;
+        }
+        size_type                 flag = bits_small + 1;
+        bucket_type*              b0   = table_off(n_large);
+        bucket_type*              b1   = b0 + flag;
+        std::vector<value_intern> buffer;
 
-    //     capacity    -= (bits_small+1) * bs;
-    //     grow_thresh  = std::ceil((capacity + (bits_large+1)*bs)/alpha);
-    //     shrnk_thresh = std::ceil((capacity - (bits_large+1)*bs)/alpha);
-    //     if (bits_small == 0 && !n_large) shrnk_thresh = 0;
-    // }
+        for (size_type i = 0; i < flag; ++i, b0++, b1++)
+        {
+            for (size_type j = 0; j < bs; ++j)
+            {
+                auto e = b1->elements[j];
+                if (!e.first) break;
+                if (!b0->insert(e)) buffer.push_back(e);
+            }
+            *b1 = bucket_type();
+        }
 
-    // inline void migrate_shrnk(size_type tab, std::unique_ptr<bucket_type[]>&
-    // target,
-    //                           std::vector<std::pair<key_type, mapped_type> >&
-    //                           buffer)
-    // {
-    //     size_type flag = bits_small + 1;
-
-    //     for (size_type i = 0; i < flag; ++i)
-    //     {
-    //         bucket_type* curr  = &(llt[tab][i]);
-    //         bucket_type* curr1 = &(llt[tab][i+flag]);
-    //         bucket_type* targ  = &(target[i]);
-    //         size_type ind = 0;
-    //         for (size_type j = 0; j < bs; ++j)
-    //         {
-    //             auto e = curr->elements[j];
-    //             if (! e.first) break;
-    //             auto hash = hasher(e.first);
-
-    //             for (size_type ti = 0; ti < nh; ++ti)
-    //             {
-    //                 if ( ext::tab(hash, ti)  == tab &&
-    //                     (ext::loc(hash, ti) & bits_small) == i)
-    //                 {
-    //                     targ->elements[ind++] = e;
-    //                     break;
-    //                 }
-    //             }
-    //         }
-
-    //         for (size_type j = 0; j < bs; ++j)
-    //         {
-    //             auto e = curr1->elements[j];
-    //             if (! e.first)
-    //             { break; }
-    //             else if (ind >= bs)
-    //             { buffer.push_back(e); }
-    //             else
-    //             {
-    //                 auto hash = hasher(e.first);
-    //                 for (size_type ti = 0; ti < nh; ++ti)
-    //                 {
-    //                     if ( ext::tab(hash, ti)  == tab &&
-    //                          (ext::loc(hash, ti) & bits_small) == i)
-    //                     {
-    //                         targ->elements[ind++] = e;
-    //                         break;
-    //                     }
-    //                 }
-    //             }
-    //         }
-    //     }
-    // }
+        n -= buffer.size();
+        for (auto& e : buffer) base_type::insert(e);
 
-    // inline void finish_shrnk(std::vector<std::pair<key_type, mapped_type> >&
-    // buffer)
-    // {
-    //     size_type bla = 0;
-    //     n -= buffer.size();
-    //     for (auto& e : buffer)
-    //     {
-    //         bla += (base_type::insert(e).second) ? 1: 0;
-    //     }
-    // }
+        capacity -= flag * bs;
+        pressure = false;
+        set_thresholds();
+        if (bits_small == 0 && !n_large) shrnk_thresh = 0;
+    }
 };
 
 
@@ -804,7 +1224,7 @@ class iterator_incr<cuckoo_dysect_inplace<K, D, HF, Conf> >
 
   private:
     using size_type               = typename table_type::size_type;
-    using ipointer                = std::pair<const K, D>*;
+    using ipointer                = typename element_traits<K, D>::value_table*;
     static constexpr size_type tl = Conf::tl;
     static constexpr size_type bs = Conf::bs;
 
@@ -827,9 +1247,14 @@ class iterator_incr<cuckoo_dysect_inplace<K, D, HF, Conf> >
             if (!temp) return nullptr;
         }
 
-        while (!temp->first)
+        while (!element_traits<K, D>::key(*temp))
         {
-            if (++temp > end_tab) return overflow_tab();
+            // the first slot of the next subtable can be empty too
+            if (++temp > end_tab)
+            {
+                temp = overflow_tab();
+                if (!temp) return nullptr;
+            }
         }
         return temp;
     }
@@ -874,4 +1299,38 @@ class iterator_incr<cuckoo_dysect_inplace<K, D, HF, Conf> >
     }
 };
 
+
+
+
+// *****************************************************************************
+// OUT OF LINE VALUES **********************************************************
+// *****************************************************************************
+
+// buckets only contain keys and 32-bit indices into a value arena
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = cuckoo_config<> >
+using cuckoo_dysect_indirect = indirect_table<cuckoo_dysect, K, D, HF, Conf>;
+
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = cuckoo_config<> >
+using cuckoo_dysect_inplace_indirect =
+    indirect_table<cuckoo_dysect_inplace, K, D, HF, Conf>;
+
+
+
+
+// *****************************************************************************
+// STRING KEYS *****************************************************************
+// *****************************************************************************
+
+// buckets contain string fingerprints and offsets into an interned arena
+template <class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = cuckoo_config<> >
+using cuckoo_dysect_string = string_table<cuckoo_dysect, D, HF, Conf>;
+
+template <class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = cuckoo_config<> >
+using cuckoo_dysect_inplace_string =
+    string_table<cuckoo_dysect_inplace, D, HF, Conf>;
+
 } // namespace dysect
@@ -0,0 +1,779 @@
+#pragma once
+
+/*******************************************************************************
+ * include/cuckoo_dysect_compact.hpp
+ *
+ * cuckoo_dysect_compact is a DySECT variant with quotiented keys.
+ * Keys are hashed with a bijective hash function, the subtable
+ * (ext::tab) and the lowest QBITS bits of the bucket offset
+ * (ext::loc) are implied by the position of an element.  Therefore,
+ * each slot only stores the remaining hash bits together with the
+ * number of the used hash function (hash choice).  The position of
+ * the remaining nh-1 buckets can be computed from the stored bits.
+ *
+ * With tl=256, QBITS=10 and nh<=3 each key is stored in 6 bytes.
+ * All subtables contain at least 2^QBITS buckets.  Elements are
+ * stored in packed slots (mapped data is not aligned).  Iterators
+ * reconstruct keys on the fly, i.e., they return pairs of a key and
+ * a reference to the mapped data (proxy iterators).
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "utils/output.hpp"
+
+#include "cuckoo_base.hpp"
+#include "element_traits.hpp"
+#include "hasher.hpp"
+#include "integer_hash.hpp"
+
+namespace otm = utils_tm::out_tm;
+
+namespace dysect
+{
+
+// slots of quotiented tables (WB bytes of hash remainder + mapped data)
+#pragma pack(push, 1)
+template <size_t WB, class D> struct compact_element
+{
+    unsigned char word[WB];
+    D             second;
+};
+
+template <size_t WB> struct compact_element<WB, void>
+{
+    unsigned char word[WB];
+};
+#pragma pack(pop)
+
+template <size_t WB, class D>
+inline uint64_t get_word(const compact_element<WB, D>& e)
+{
+    uint64_t w = 0;
+    std::memcpy(&w, e.word, WB);
+    return w;
+}
+
+template <size_t WB, class D>
+inline void set_word(compact_element<WB, D>& e, uint64_t w)
+{
+    std::memcpy(e.word, &w, WB);
+}
+
+
+
+template <class K, class D, class HF = bijective_hash,
+          class Conf = cuckoo_config<>, size_t QBITS = 10>
+class cuckoo_dysect_compact
+{
+  private:
+    using this_type = cuckoo_dysect_compact<K, D, HF, Conf, QBITS>;
+    template <bool> class iterator_type;
+
+  public:
+    using size_type   = size_t;
+    using key_type    = K;
+    using mapped_type = D;
+
+    using iterator           = iterator_type<false>;
+    using const_iterator     = iterator_type<true>;
+    using insert_return_type = std::pair<iterator, bool>;
+
+  private:
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
+    static constexpr bool is_set = element_traits<K, D>::is_set;
+
+    static constexpr size_type bs = Conf::bs;
+    static constexpr size_type tl = Conf::tl;
+    static constexpr size_type nh = Conf::nh;
+
+    // bit layout of a hash value (see hash_value_splitter<tw, true>)
+    // [tab0 | loc0 | tab1 | loc1], loc_i = loc0 + i*(loc1|1) (same for tab)
+    static constexpr size_type tw       = ct_log(tl);
+    static constexpr size_type lw       = 32 - tw;
+    static constexpr size_type cb       = ct_log(nh + 1); // hash choice + 1
+    static constexpr size_type qw       = tw + QBITS;
+    static constexpr size_type word_w   = 64 - qw + cb;
+    static constexpr size_type wb       = (word_w + 7) / 8;
+    static constexpr uint64_t  tab_mask = (1ull << tw) - 1;
+    static constexpr uint64_t  loc_mask = (1ull << lw) - 1;
+    static constexpr uint64_t  q_mask   = (1ull << QBITS) - 1;
+    static constexpr uint64_t  c_mask   = (1ull << cb) - 1;
+
+    static_assert(sizeof(K) == 8 && std::is_integral<K>::value,
+                  "compact keys need 64-bit integer keys");
+    static_assert(qw <= 32, "implied bits have to be part of the first half");
+    static_assert((1ull << tw) == tl, "tl has to be a power of two");
+
+    // displacement (see displace) and growth (one subtable per growth
+    // event, see grow) are built in, other strategies and policies of
+    // Conf are not implemented
+    static_assert(
+        std::is_same<typename Conf::template dis_strat_type<this_type>,
+                     cuckoo_displacement::bfs<this_type>>::value,
+        "compact tables only displace with breadth first search "
+        "(cuckoo_displacement::bfs)");
+    static_assert(std::is_same<typename Conf::history_type, history_none>::value,
+                  "compact tables do not support histories (or rehashing)");
+    static_assert(
+        std::is_same<typename Conf::growth_type, dysect_growth<>>::value,
+        "compact tables only support the default growth policy");
+    static_assert(
+        std::is_same<typename Conf::versions_type, versions_none>::value,
+        "compact tables do not support bucket_versions");
+
+    using element_type = compact_element<wb, mapped_type>;
+
+    struct bucket_type
+    {
+        element_type elements[bs];
+    };
+
+  public:
+    // the displacement is deterministic, thus, seed selects the hash
+    // function instead (seed 0 is the default function)
+    cuckoo_dysect_compact(size_type cap = 0, double size_constraint = 1.1,
+                          size_type dis_steps = 256, size_type seed = 0)
+        : n(0), alpha(size_constraint), steps(dis_steps + 1),
+          fct(2345745572344267838ull ^ seed)
+    {
+        double avg_size_f = double(cap) * size_constraint / double(tl * bs);
+
+        size_type size_small = 1ull << QBITS;
+        while (avg_size_f > (size_small << 1)) size_small <<= 1;
+
+        n_large =
+            (size_small < avg_size_f)
+                ? std::floor(double(cap) * alpha / double(size_small * bs)) - tl
+                : 0;
+        n_large = std::min(n_large, tl);
+
+        for (size_type i = 0; i < n_large; ++i)
+        {
+            llt[i] = std::make_unique<bucket_type[]>(size_small << 1);
+        }
+
+        for (size_type i = n_large; i < tl; ++i)
+        {
+            llt[i] = std::make_unique<bucket_type[]>(size_small);
+        }
+
+        capacity   = (n_large + tl) * size_small * bs;
+        bits_small = size_small - 1;
+        bits_large = (size_small << 1) - 1;
+
+        if (n_large == tl)
+        {
+            n_large    = 0;
+            bits_small = bits_large;
+            bits_large = (bits_large << 1) + 1;
+        }
+
+        grow_thresh = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
+    }
+
+    cuckoo_dysect_compact(const cuckoo_dysect_compact&) = delete;
+    cuckoo_dysect_compact& operator=(const cuckoo_dysect_compact&) = delete;
+
+    cuckoo_dysect_compact(cuckoo_dysect_compact&&) = default;
+    cuckoo_dysect_compact& operator=(cuckoo_dysect_compact&&) = default;
+
+  private:
+    size_type n;
+    size_type capacity;
+    size_type grow_thresh;
+    double    alpha;
+    size_type steps;
+    HF        fct;
+
+    size_type n_large;
+    size_type bits_small;
+    size_type bits_large;
+
+    std::unique_ptr<bucket_type[]> llt[tl];
+
+  public:
+    // Basic Hash Table Functionality ******************************************
+    iterator find(const key_type& k)
+    {
+        auto h = fct(k);
+        for (size_type i = 0; i < nh; ++i)
+        {
+            auto [tab, loc] = position(h, i);
+            auto j          = search(llt[tab][loc], encode(h, i));
+            if (j < bs) return iterator(this, tab, loc, j);
+        }
+        return end();
+    }
+
+    const_iterator find(const key_type& k) const
+    {
+        return const_cast<this_type*>(this)->find(k);
+    }
+
+    template <class M = mapped_type>
+    insert_return_type
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
+    {
+        return insert(std::make_pair(k, d));
+    }
+
+    // on sets (mapped_type void) elements are inserted with insert(k)
+    insert_return_type insert(const value_intern& t);
+    size_type          erase(const key_type& k);
+    int                displacement(const key_type& k) const;
+
+    // Easy use Accessors for std compliance ***********************************
+    iterator begin()
+    {
+        auto it = iterator(this, 0, 0, 0);
+        if (!get_word(llt[0][0].elements[0])) it++;
+        return it;
+    }
+    const_iterator begin() const { return cbegin(); }
+    const_iterator cbegin() const
+    {
+        return const_cast<this_type*>(this)->begin();
+    }
+    iterator       end() { return iterator(this, tl, 0, 0); }
+    const_iterator end() const { return cend(); }
+    const_iterator cend() const { return const_iterator(this, tl, 0, 0); }
+
+    template <class M = mapped_type>
+    enable_if_mapped<M, M>& at(const key_type& k)
+    {
+        auto a = find(k);
+        if (a == end()) throw std::out_of_range("cannot find key");
+        return (*a).second;
+    }
+    template <class M = mapped_type>
+    const enable_if_mapped<M, M>& at(const key_type& k) const
+    {
+        return const_cast<this_type*>(this)->at(k);
+    }
+    template <class M = mapped_type>
+    enable_if_mapped<M, M>& operator[](const key_type& k)
+    {
+        auto t = insert(k, mapped_type());
+        return (*t.first).second;
+    }
+    size_type count(const key_type& k) const
+    {
+        return (find(k) != cend()) ? 1 : 0;
+    }
+
+    // Global fill state *******************************************************
+    inline size_type empty() const { return (n == 0); }
+    inline size_type size() const { return n; }
+    inline size_type max_size() const { return (1ull << 32) * bs; }
+
+    // Capacity ****************************************************************
+    // see cuckoo_base (subtables keep at least 2^QBITS buckets, since the
+    // bucket offset contains the implied bits of the stored words)
+    void reserve(size_type k);
+    void shrink_to_fit();
+    void clear(clear_mode mode = clear_mode::lazy)
+    {
+        for (size_type t = 0; t < tl; ++t)
+            zero_range(llt[t].get(), llt[t].get() + bitmask(t) + 1, mode);
+        n = 0;
+    }
+
+  private:
+    // Quotienting *************************************************************
+    static inline std::pair<size_type, size_type>
+    split(uint64_t h, size_type i)
+    {
+        uint64_t tab0 = h & tab_mask;
+        uint64_t loc0 = (h >> tw) & loc_mask;
+        uint64_t tab1 = (h >> 32) & tab_mask;
+        uint64_t loc1 = (h >> (32 + tw)) & loc_mask;
+        return std::make_pair((tab0 + i * (tab1 | 1)) & tab_mask,
+                              (loc0 + i * (loc1 | 1)) & loc_mask);
+    }
+
+    inline size_type bitmask(size_type tab) const
+    {
+        return (tab < n_large) ? bits_large : bits_small;
+    }
+
+    inline std::pair<size_type, size_type> position(uint64_t h,
+                                                    size_type i) const
+    {
+        auto [tab, loc] = split(h, i);
+        return std::make_pair(tab, loc & bitmask(tab));
+    }
+
+    // stored word: hash bits above qw, followed by the hash choice (+1)
+    static inline uint64_t encode(uint64_t h, size_type i)
+    {
+        return ((h >> qw) << cb) | (i + 1);
+    }
+
+    // any bucket offset contains the lowest QBITS bits of the loc value
+    static inline uint64_t decode(uint64_t word, size_type tab, size_type loc)
+    {
+        uint64_t i    = (word & c_mask) - 1;
+        uint64_t high = (word >> cb) << qw;
+        uint64_t tab1 = (high >> 32) & tab_mask;
+        uint64_t loc1 = (high >> (32 + tw)) & loc_mask;
+        uint64_t tab0 = (tab - i * (tab1 | 1)) & tab_mask;
+        uint64_t loc0 = (loc - i * (loc1 | 1)) & q_mask;
+        return high | (loc0 << tw) | tab0;
+    }
+
+    static inline size_type choice(uint64_t word)
+    {
+        return (word & c_mask) - 1;
+    }
+
+    static inline size_type search(const bucket_type& b, uint64_t word)
+    {
+        for (size_type j = 0; j < bs; ++j)
+        {
+            auto w = get_word(b.elements[j]);
+            if (w == word) return j;
+            if (!w) break;
+        }
+        return bs;
+    }
+
+    static inline size_type first_free(const bucket_type& b)
+    {
+        for (size_type j = 0; j < bs; ++j)
+        {
+            if (!get_word(b.elements[j])) return j;
+        }
+        return bs;
+    }
+
+    inline key_type key_at(size_type tab, size_type loc, size_type j) const
+    {
+        return fct.inverse(
+            decode(get_word(llt[tab][loc].elements[j]), tab, loc));
+    }
+
+    // Displacement (bfs) ******************************************************
+    struct bfs_item
+    {
+        int          prev; // index of the predecessor in the queue
+        size_type    slot; // moved element (in the predecessor's bucket)
+        uint64_t     word; // word of the moved element in its new bucket
+        bucket_type* b;
+        size_type    tab;
+        size_type    loc;
+    };
+
+    element_type* displace(uint64_t h);
+
+    // Size changes (GROWING) **************************************************
+    void grow();
+    void migrate_to(size_type tab, size_type nbits);
+    void shrink();
+
+    void inc_n() { ++n; }
+
+  public:
+    // auxiliary functions for testing *****************************************
+    static void print_init_header(otm::output_type& out)
+    {
+        out << otm::width(6) << "bsize" << otm::width(6) << "ntabl"
+            << otm::width(6) << "nhash" << otm::width(6) << "wbyte"
+            << otm::width(9) << "f_cap" << std::flush;
+    }
+    void print_init_data(otm::output_type& out)
+    {
+        out << otm::width(6) << bs << otm::width(6) << tl << otm::width(6)
+            << nh << otm::width(6) << wb << otm::width(9) << capacity
+            << std::flush;
+    }
+
+  private:
+    // Iterator (proxy) ********************************************************
+    template <bool is_const> class iterator_type
+    {
+      private:
+        using table_ptr =
+            typename std::conditional<is_const, const this_type*,
+                                      this_type*>::type;
+        using mapped_ref = typename std::add_lvalue_reference<
+            typename std::conditional<is_const, const mapped_type,
+                                      mapped_type>::type>::type;
+
+      public:
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using reference =
+            typename std::conditional<is_set, key_type,
+                                      std::pair<const key_type,
+                                                mapped_ref> >::type;
+        using value_type = reference;
+
+        struct pointer
+        {
+            reference  ref;
+            reference* operator->() { return &ref; }
+        };
+
+        iterator_type(table_ptr table, size_type tab, size_type loc,
+                      size_type j)
+            : table(table), tab(tab), loc(loc), j(j)
+        {
+        }
+        template <bool b, class = typename std::enable_if<is_const || !b>::type>
+        iterator_type(const iterator_type<b>& rhs)
+            : table(rhs.table), tab(rhs.tab), loc(rhs.loc), j(rhs.j)
+        {
+        }
+
+        iterator_type& operator++(int)
+        {
+            auto size = table->bitmask(tab);
+            if (++j >= bs ||
+                !get_word(table->llt[tab][loc].elements[j])) // front packed
+            {
+                j = 0;
+                do {
+                    if (++loc > size)
+                    {
+                        loc = 0;
+                        if (++tab >= tl) return *this;
+                        size = table->bitmask(tab);
+                    }
+                } while (!get_word(table->llt[tab][loc].elements[0]));
+            }
+            return *this;
+        }
+
+        reference operator*() const
+        {
+            if constexpr (is_set)
+                return table->key_at(tab, loc, j);
+            else
+                return reference(table->key_at(tab, loc, j),
+                                 table->llt[tab][loc].elements[j].second);
+        }
+        pointer operator->() const { return pointer{**this}; }
+
+        bool operator==(const iterator_type& rhs) const
+        {
+            return tab == rhs.tab && loc == rhs.loc && j == rhs.j;
+        }
+        bool operator!=(const iterator_type& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+      private:
+        template <bool> friend class iterator_type;
+
+        table_ptr table;
+        size_type tab;
+        size_type loc;
+        size_type j;
+    };
+};
+
+
+
+// Implementation of main functionality ****************************************
+
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline typename cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::insert_return_type
+cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::insert(const value_intern& t)
+{
+    if (n > grow_thresh) grow();
+    auto h = fct(t.first);
+
+    size_type best = bs, best_i = 0;
+    for (size_type i = 0; i < nh; ++i)
+    {
+        auto [tab, loc] = position(h, i);
+        auto& b         = llt[tab][loc];
+        auto  j         = search(b, encode(h, i));
+        if (j < bs) return std::make_pair(iterator(this, tab, loc, j), false);
+
+        auto f = first_free(b);
+        if (f < best)
+        {
+            best   = f;
+            best_i = i;
+        }
+    }
+
+    if (best < bs)
+    {
+        auto [tab, loc] = position(h, best_i);
+        auto& e         = llt[tab][loc].elements[best];
+        set_word(e, encode(h, best_i));
+        if constexpr (!is_set) e.second = t.second;
+        inc_n();
+        return std::make_pair(iterator(this, tab, loc, best), true);
+    }
+
+    auto pos = displace(h);
+    if (!pos)
+    {
+        if constexpr (!Conf::fix_errors) return std::make_pair(end(), false);
+        grow();
+        return insert(t);
+    }
+    if constexpr (!is_set) pos->second = t.second;
+    inc_n();
+    return std::make_pair(find(t.first), true);
+}
+
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline typename cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::size_type
+cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::erase(const key_type& k)
+{
+    auto h = fct(k);
+    for (size_type i = 0; i < nh; ++i)
+    {
+        auto [tab, loc] = position(h, i);
+        auto& b         = llt[tab][loc];
+        auto  j         = search(b, encode(h, i));
+        if (j < bs)
+        {
+            auto last   = first_free(b) - 1;
+            b.elements[j] = b.elements[last];
+            std::memset(&b.elements[last], 0, sizeof(element_type));
+            --n;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline int
+cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::displacement(const key_type& k) const
+{
+    auto h    = fct(k);
+    int  disp = 0;
+    for (size_type i = 0; i < nh; ++i)
+    {
+        auto [tab, loc] = position(h, i);
+        auto j          = search(llt[tab][loc], encode(h, i));
+        if (j < bs) return disp + j;
+        disp += bs;
+    }
+    return -1;
+}
+
+
+
+// Displacement ****************************************************************
+// breadth first search similar to dis_bfs1, moved elements are re-encoded,
+// since their hash choice changes
+
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline typename cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::element_type*
+cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::displace(uint64_t h)
+{
+    std::vector<bfs_item> bq;
+    for (size_type i = 0; i < nh; ++i)
+    {
+        auto [tab, loc] = position(h, i);
+        bq.push_back(bfs_item{-1, 0, encode(h, i), &llt[tab][loc], tab, loc});
+    }
+
+    bool found = false;
+    for (size_type q = 0; q < bq.size() && q < steps && !found; ++q)
+    {
+        auto cur = bq[q];
+        for (size_type j = 0; j < bs && bq.size() < steps && !found; ++j)
+        {
+            auto w  = get_word(cur.b->elements[j]);
+            auto eh = decode(w, cur.tab, cur.loc);
+            for (size_type i = 0; i < nh; ++i)
+            {
+                if (i == choice(w)) continue;
+                auto [tab, loc] = position(eh, i);
+                bucket_type* b  = &llt[tab][loc];
+                if (b == cur.b) continue;
+
+                bq.push_back(bfs_item{int(q), j, encode(eh, i), b, tab, loc});
+                if (first_free(*b) < bs)
+                {
+                    found = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (!found) return nullptr;
+
+    // roll back the displacements (from the free slot to the new element)
+    size_type     cur = bq.size() - 1;
+    element_type* dst = &bq[cur].b->elements[first_free(*bq[cur].b)];
+    while (bq[cur].prev >= 0)
+    {
+        auto&         item = bq[cur];
+        element_type* src  = &bq[item.prev].b->elements[item.slot];
+        *dst               = *src;
+        set_word(*dst, item.word);
+        dst = src;
+        cur = item.prev;
+    }
+    set_word(*dst, bq[cur].word);
+    return dst;
+}
+
+
+
+// Size changes (GROWING) ******************************************************
+// the stored words do not depend on the subtable size
+
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline void cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::grow()
+{
+    migrate_to(n_large, bits_large);
+
+    capacity += (bits_small + 1) * bs;
+    if (++n_large == tl)
+    {
+        n_large    = 0;
+        bits_small = bits_large;
+        bits_large = (bits_large << 1) + 1;
+    }
+    grow_thresh = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
+}
+
+// moves subtable tab into nbits + 1 buckets (a multiple of its size), each
+// bucket is split into the buckets that share its lower bits
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline void
+cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::migrate_to(size_type tab,
+                                                         size_type nbits)
+{
+    size_type obits  = bitmask(tab);
+    auto      target = std::make_unique<bucket_type[]>(nbits + 1);
+
+    for (size_type i = 0; i <= obits; ++i)
+    {
+        bucket_type& curr = llt[tab][i];
+
+        for (size_type j = 0; j < bs; ++j)
+        {
+            auto w = get_word(curr.elements[j]);
+            if (!w) break;
+            auto  loc = split(decode(w, tab, i), choice(w)).second & nbits;
+            auto& tar = target[loc];
+            tar.elements[first_free(tar)] = curr.elements[j];
+        }
+    }
+    llt[tab] = std::move(target);
+}
+
+// the subtables are grown in the order of growth events until k elements
+// fit, but each subtable is migrated only once (to its final size)
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline void cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::reserve(size_type k)
+{
+    if (k <= grow_thresh) return;
+
+    size_type nl   = n_large;
+    size_type bsml = bits_small;
+    size_type blrg = bits_large;
+    size_type cap  = capacity;
+    size_type nbits[tl];
+    for (size_type t = 0; t < tl; ++t) nbits[t] = bitmask(t);
+
+    while (k > std::ceil((cap + (blrg + 1) * bs) / alpha))
+    {
+        nbits[nl] = blrg;
+        cap += (bsml + 1) * bs;
+        if (++nl == tl)
+        {
+            nl   = 0;
+            bsml = blrg;
+            blrg = (blrg << 1) + 1;
+        }
+    }
+
+    for (size_type t = 0; t < tl; ++t)
+    {
+        if (nbits[t] != bitmask(t)) migrate_to(t, nbits[t]);
+    }
+
+    n_large     = nl;
+    bits_small  = bsml;
+    bits_large  = blrg;
+    capacity    = cap;
+    grow_thresh = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
+}
+
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline void cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::shrink_to_fit()
+{
+    while (true)
+    {
+        size_type step = ((n_large) ? bits_small + 1 : (bits_small + 1) >> 1);
+        if (step < (1ull << QBITS)) break;
+        if (n * alpha > capacity - step * bs) break;
+        shrink();
+    }
+}
+
+// halves one subtable, bucket i + flag is merged into bucket i, elements
+// that do not fit are inserted again (their keys are decoded)
+template <class K, class D, class HF, class Conf, size_t QBITS>
+inline void cuckoo_dysect_compact<K, D, HF, Conf, QBITS>::shrink()
+{
+    if (n_large) { n_large--; }
+    else
+    {
+        n_large = tl - 1;
+        bits_small >>= 1;
+        bits_large >>= 1;
+    }
+    size_type tab    = n_large;
+    size_type flag   = bits_small + 1;
+    auto      target = std::make_unique<bucket_type[]>(flag);
+
+    std::vector<value_intern> buffer;
+    for (size_type i = 0; i < flag; ++i)
+    {
+        target[i] = llt[tab][i];
+        auto& b1  = llt[tab][i + flag];
+        for (size_type j = 0; j < bs; ++j)
+        {
+            auto w = get_word(b1.elements[j]);
+            if (!w) break;
+            auto f = first_free(target[i]);
+            if (f < bs)
+            {
+                target[i].elements[f] = b1.elements[j];
+                continue;
+            }
+            auto k = fct.inverse(decode(w, tab, i + flag));
+            if constexpr (is_set)
+                buffer.push_back(value_intern(k));
+            else
+                buffer.push_back(value_intern(k, b1.elements[j].second));
+        }
+    }
+    llt[tab] = std::move(target);
+
+    capacity -= flag * bs;
+    grow_thresh = std::ceil((capacity + (bits_large + 1) * bs) / alpha);
+
+    n -= buffer.size();
+    for (auto& e : buffer) insert(e);
+}
+
+} // namespace dysect
@@ -154,6 +154,38 @@ class cuckoo_independent_2lvl
         return result;
     }
 
+    // base_type::try_emplace places the element without insert
+    template <class... Args>
+    inline insert_return_type try_emplace(const key_type& k, Args&&... args)
+    {
+        auto      hash = hasher(k);
+        size_type ttl  = ext::tab(hash, 0);
+
+        auto result = base_type::try_emplace(k, std::forward<Args>(args)...);
+        if (result.second)
+        {
+            auto currsize = ++ll_elem[ttl];
+            if (currsize > ll_thresh[ttl]) grow_tab(ttl);
+        }
+        return result;
+    }
+
+    // per table counts have to be kept, thus batches are not interleaved
+    inline size_type
+    insert_batch(const std::pair<key_type, mapped_type>* elements,
+                 size_type                               count,
+                 bool*                                   results = nullptr)
+    {
+        size_type inserted = 0;
+        for (size_type i = 0; i < count; ++i)
+        {
+            bool r = insert(elements[i]).second;
+            inserted += (r) ? 1 : 0;
+            if (results) results[i] = r;
+        }
+        return inserted;
+    }
+
     size_type erase(const key_type k)
     {
         auto      hash = hasher(k);
@@ -165,6 +197,14 @@ class cuckoo_independent_2lvl
 
 
 
+    // growing is triggered for each subtable (see grow_tab), thus each
+    // subtable is resized for its share of the elements
+    inline void reserve(size_type k)
+    {
+        for (size_type i = 0; i < tl; ++i)
+            if (k / tl > ll_thresh[i]) resize_tab(i, k / tl, ll_size[i]);
+    }
+
     std::pair<size_type, bucket_type*> getTable(size_type i)
     {
         return (i < tl) ? std::make_pair(ll_size[i], ll_tab[i].get())
@@ -207,6 +247,15 @@ class cuckoo_independent_2lvl
 
 
 
+    inline void clear_buckets(clear_mode mode)
+    {
+        for (size_type i = 0; i < tl; ++i)
+        {
+            zero_range(ll_tab[i].get(), ll_tab[i].get() + ll_size[i], mode);
+            ll_elem[i] = 0;
+        }
+    }
+
     // Size changes (GROWING) **************************************************
     void grow()
     {
@@ -215,14 +264,20 @@ class cuckoo_independent_2lvl
     }
 
     inline void grow_tab(size_type tab)
+    {
+        resize_tab(tab, ll_elem[tab], ll_size[tab] + 1);
+    }
+
+    // migrates subtable tab into buckets for k elements (at least min_size)
+    inline void resize_tab(size_type tab, size_type k, size_type min_size)
     {
         // otm::out() << "growing in table" << tab << std::endl;
         // TODO make this prettier
-        size_type nsize = std::floor(double(ll_elem[tab]) * alpha / double(bs));
-        nsize           = std::max(nsize, ll_size[tab] + 1);
+        size_type nsize = std::floor(double(k) * alpha / double(bs));
+        nsize           = std::max(nsize, min_size);
         capacity += (nsize - ll_size[tab]) * bs;
         // double nfactor = double(nsize)      / fac_div;
-        size_type nthresh = ll_elem[tab] * beta;
+        size_type nthresh = k * beta;
 
         std::vector<value_intern> grow_buffer;
 
@@ -267,6 +322,7 @@ class cuckoo_independent_2lvl
 
     inline void finalize_grow(std::vector<value_intern>& grow_buffer)
     {
+        n -= grow_buffer.size(); // n will be increased by insertions
         for (auto& e : grow_buffer) { base_type::insert(e); }
     }
 };
@@ -291,6 +347,9 @@ class cuckoo_traits<cuckoo_independent_2lvl<K, D, HF, Conf> >
     static constexpr size_t nh = Conf::nh;
     static_assert(!config_type::fix_errors,
                   "2lvl independent table does not support fix_errors!");
+    static_assert(!config_type::versions_type::enabled,
+                  "2lvl independent table grows its subtables on insert, "
+                  "it does not support bucket_versions!");
     static constexpr bool fix_errors = false;
 
     using hasher_type = hasher<K, HF, ct_log(tl), nh, true, true>;
@@ -332,7 +391,12 @@ class iterator_incr<cuckoo_independent_2lvl<K, D, HF, Conf> >
 
         while (!temp->first)
         {
-            if (++temp > end_tab) return overflow_tab();
+            // the first slot of the next subtable can be empty too
+            if (++temp > end_tab)
+            {
+                temp = overflow_tab();
+                if (!temp) return nullptr;
+            }
         }
         return temp;
     }
@@ -362,7 +426,7 @@ class iterator_incr<cuckoo_independent_2lvl<K, D, HF, Conf> >
             if (tab_b_ptr <= ptr && ptr < tab_e_ptr)
             {
                 tab     = i;
-                end_tab = tab_e_ptr;
+                end_tab = tab_e_ptr - 1; // last slot (as in overflow_tab)
                 return;
             }
         }
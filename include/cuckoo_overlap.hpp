@@ -132,17 +132,26 @@ class cuckoo_overlap
 
 
 
+    inline void clear_buckets(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+    }
+
     // Size changes (GROWING) **************************************************
 
-    inline void grow()
+    inline void grow() { resize(n, n_subbuckets + min_grow_buckets); }
+
+    // migrates all elements into a table with subbuckets for k elements
+    // (at least min_subbuckets), also used by reserve and shrink_to_fit
+    inline void resize(size_type k, size_type min_subbuckets = 256)
     {
         // if (!fix_errors && grow_buffer.size()) return; // I think this should
         // not happen
-        size_type nsize = size_type(double(n) * alpha) / sbs;
-        nsize           = std::max(nsize, n_subbuckets + min_grow_buckets);
+        size_type nsize = size_type(double(k) * alpha) / sbs;
+        nsize           = std::max(nsize, min_subbuckets);
         // double nfactor  = double(nsize+1-(bs/sbs))/double(1ull << 32);
         size_type ncap    = nsize + 1 - (bs / sbs);
-        size_type nthresh = n * beta;
+        size_type nthresh = beta * std::max<size_type>(256ull, k);
 
         // std::cout << n << " " << n_buckets << " -> " << nsize << std::endl;
 
@@ -379,22 +388,42 @@ class cuckoo_overlap_inplace
 
 
 
+    inline void clear_buckets(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+    }
+
     // Size changes (GROWING) **************************************************
 
-    inline void grow()
+    inline void grow() { resize(n, n_subbuckets + min_grow_buckets); }
+
+    // see cuckoo_overlap::resize, the in place migration only grows, a
+    // smaller table is refilled from a buffer of all elements
+    inline void resize(size_type k, size_type min_subbuckets = 256)
     {
-        size_type nsize = size_type(double(n) * alpha) / sbs;
-        nsize           = std::max(nsize, n_subbuckets + min_grow_buckets);
-        capacity        = nsize * sbs;
+        size_type nsize = size_type(double(k) * alpha) / sbs;
+        nsize           = std::max(nsize, min_subbuckets);
         // double    nfactor = double(nsize+1-(bs/sbs))/double(1ull << 32);
         size_type ncap    = nsize + 1 - (bs / sbs);
-        size_type nthresh = n * beta;
-
-        std::fill(table.get() + capacity, table.get() + (nsize * sbs),
-                  value_intern());
+        size_type nthresh = beta * std::max<size_type>(256ull, k);
 
         std::vector<value_intern> grow_buffer;
-        migrate(ncap, grow_buffer);
+        if (nsize < n_subbuckets)
+        {
+            for (size_type i = 0; i < capacity; ++i)
+            {
+                if (table[i].first) grow_buffer.push_back(table[i]);
+                table[i] = value_intern();
+            }
+        }
+        else
+        {
+            // the migration scans the old capacity
+            std::fill(table.get() + capacity, table.get() + (nsize * sbs),
+                      value_intern());
+            migrate(ncap, grow_buffer);
+        }
+        capacity = nsize * sbs;
 
         n_subbuckets = nsize;
         grow_thresh  = nthresh;
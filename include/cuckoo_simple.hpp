@@ -56,7 +56,8 @@ class cuckoo_standard
     using const_iterator = typename base_type::const_iterator;
 
   private:
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
   public:
     cuckoo_standard(size_type cap             = 0,
@@ -123,14 +124,14 @@ class cuckoo_standard
     inline iterator begin()
     {
         auto temp = make_iterator(&table[0].elements[0]);
-        if (!temp->first) temp++;
+        if (!table[0].elements[0].first) temp++;
         return temp;
     }
 
     inline const_iterator cbegin() const
     {
         auto temp = make_citerator(&table[0].elements[0]);
-        if (!temp->first) temp++;
+        if (!table[0].elements[0].first) temp++;
         return temp;
     }
 
@@ -160,15 +161,24 @@ class cuckoo_standard
 
 
 
+    inline void clear_buckets(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + n_buckets, mode);
+    }
+
     // Size changes (GROWING) **************************************************
 
-    inline void grow()
+    inline void grow() { resize(n, n_buckets + min_grow_buckets); }
+
+    // migrates all elements into a table with buckets for k elements (at
+    // least min_buckets), this is also used by reserve and shrink_to_fit
+    inline void resize(size_type k, size_type min_buckets = 256)
     {
-        size_type nsize = size_type(double(n) * alpha) / bs;
-        nsize           = std::max(nsize, n_buckets + min_grow_buckets);
+        size_type nsize = size_type(double(k) * alpha) / bs;
+        nsize           = std::max(nsize, min_buckets);
         capacity        = nsize * bs;
         // double nfactor = double(nsize)/double(1ull << 32);
-        size_type nthresh = n * beta;
+        size_type nthresh = beta * std::max<size_type>(256ull, k);
 
         // std::cout << n << " " << n_buckets << " -> " << nsize << std::endl;
 
@@ -203,7 +213,7 @@ class cuckoo_standard
                     {
                         if (!target[utils_tm::fastrange32(nsize,
                                                           ext::loc(hash, ti))]
-                                 .insert(e.first, e.second))
+                                 .insert(e))
                         {
                             grow_buffer.push_back(e);
                         }
@@ -258,7 +268,7 @@ class iterator_incr<cuckoo_standard<K, D, HF, Conf> >
 
   private:
     using size_type               = typename table_type::size_type;
-    using pointer                 = std::pair<const K, D>*;
+    using pointer                 = typename element_traits<K, D>::value_table*;
     static constexpr size_type bs = Conf::bs;
 
   public:
@@ -274,7 +284,7 @@ class iterator_incr<cuckoo_standard<K, D, HF, Conf> >
     {
         while (cur < end_ptr)
         {
-            if ((++cur)->first) return cur;
+            if (element_traits<K, D>::key(*++cur)) return cur;
         }
         return nullptr;
     }
@@ -320,7 +330,8 @@ class cuckoo_standard_inplace
     using const_iterator = typename base_type::const_iterator;
 
   private:
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
     static constexpr size_type bs    = cuckoo_traits<this_type>::bs;
     static constexpr size_type nh    = cuckoo_traits<this_type>::nh;
@@ -387,14 +398,14 @@ class cuckoo_standard_inplace
     inline iterator begin()
     {
         auto temp = make_iterator(&table[0].elements[0]);
-        if (!temp->first) temp++;
+        if (!table[0].elements[0].first) temp++;
         return temp;
     }
 
     inline const_iterator cbegin() const
     {
         auto temp = make_citerator(&table[0].elements[0]);
-        if (!temp->first) temp++;
+        if (!table[0].elements[0].first) temp++;
         return temp;
     }
 
@@ -415,20 +426,45 @@ class cuckoo_standard_inplace
 
 
 
+    inline void clear_buckets(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + n_buckets, mode);
+    }
+
     // Size changes (GROWING) **************************************************
 
-    inline void grow()
+    inline void grow() { resize(n, n_buckets + min_grow_buckets); }
+
+    // see cuckoo_standard::resize, the in place migration only grows, a
+    // smaller table is refilled from a buffer of all elements
+    inline void resize(size_type k, size_type min_buckets = 256)
     {
-        size_type nsize = size_type(double(n) * alpha) / bs;
-        nsize           = std::max(nsize, n_buckets + min_grow_buckets);
+        size_type nsize = size_type(double(k) * alpha) / bs;
+        nsize           = std::max(nsize, min_buckets);
         capacity        = nsize * bs;
         // double    nfactor = double(nsize)/double(1ull << 32);
-        size_type nthresh = n * beta;
-
-        std::fill(table.get() + n_buckets, table.get() + nsize, bucket_type());
+        size_type nthresh = beta * std::max<size_type>(256ull, k);
 
         std::vector<value_intern> grow_buffer;
-        migrate(nsize, grow_buffer);
+        if (nsize < n_buckets)
+        {
+            for (size_type i = 0; i < n_buckets; ++i)
+            {
+                for (size_type j = 0; j < bs; ++j)
+                {
+                    auto e = table[i].elements[j];
+                    if (!e.first) break;
+                    grow_buffer.push_back(e);
+                }
+                table[i] = bucket_type();
+            }
+        }
+        else
+        {
+            std::fill(table.get() + n_buckets, table.get() + nsize,
+                      bucket_type());
+            migrate(nsize, grow_buffer);
+        }
 
         n_buckets   = nsize;
         grow_thresh = nthresh;
@@ -456,7 +492,7 @@ class cuckoo_standard_inplace
                         int nbucket =
                             utils_tm::fastrange32(nsize, ext::loc(hash, ti));
                         if ((i == nbucket) ||
-                            (!table[nbucket].insert(e.first, e.second)))
+                            (!table[nbucket].insert(e)))
                         {
                             grow_buffer.push_back(e);
                         }
@@ -512,7 +548,7 @@ class iterator_incr<cuckoo_standard_inplace<K, D, HF, Conf> >
 
   private:
     using size_type               = typename table_type::size_type;
-    using pointer                 = std::pair<const K, D>*;
+    using pointer                 = typename element_traits<K, D>::value_table*;
     static constexpr size_type bs = Conf::bs;
 
   public:
@@ -528,7 +564,7 @@ class iterator_incr<cuckoo_standard_inplace<K, D, HF, Conf> >
     {
         while (cur < end_ptr)
         {
-            if ((++cur)->first) return cur;
+            if (element_traits<K, D>::key(*++cur)) return cur;
         }
         return nullptr;
     }
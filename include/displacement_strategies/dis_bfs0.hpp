@@ -26,7 +26,8 @@ template <class Parent> class dis_bfs0
   private:
     using key_type     = typename Parent::key_type;
     using mapped_type  = typename Parent::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
     using parent_type  = typename Parent::This_t;
     using hashed_type  = typename Parent::hashed_type;
     using bucket_type  = typename Parent::bucket_type;
@@ -4,7 +4,10 @@
  * include/displacement_strategies/dis_bfs1.h
  *
  * dis_bfs1 implements the bfs displacement strategy. This variant
- * is necessary for the overlapping buckets implementation.
+ * is necessary for the overlapping buckets implementation.  The path
+ * is executed from its end, each element is copied into its new slot
+ * before its old slot is overwritten, thus, it is always visible in
+ * one of its buckets (see bucket_versions for concurrent readers).
  *
  * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
  *
@@ -27,7 +30,8 @@ template <class Parent> class dis_bfs1
   private:
     using key_type     = typename Parent::key_type;
     using mapped_type  = typename Parent::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
     using parent_type  = typename Parent::this_type;
     using hashed_type  = typename Parent::hashed_type;
     using bucket_type  = typename Parent::bucket_type;
@@ -41,6 +45,8 @@ template <class Parent> class dis_bfs1
     static constexpr size_t nh = parent_type::nh;
 
   public:
+    static constexpr bool copy_before_clear = true;
+
     dis_bfs1(Parent& parent, size_t steps = 256, size_t = 0)
         : tab(parent), steps(steps + 1)
     { /* parameter is for symmetry with "rwalk" therefore unused*/
@@ -110,7 +116,9 @@ template <class Parent> class dis_bfs1
         std::tie(k1, prev1, b1) = bq[bq.size() - 1];
 
         value_intern* t = b1->probe_ptr(key_type()).second;
-        (*t)            = *k1;
+        tab.versions.lock(b1);
+        (*t) = *k1;
+        tab.versions.unlock(b1);
 
         value_intern* k2;
         int           prev2;
@@ -119,8 +127,12 @@ template <class Parent> class dis_bfs1
         value_intern* k0 = nullptr;
         while (prev1 >= 0)
         {
+            // k1 (already copied) is a slot of the bucket expanded at
+            // prev1, it is overwritten with its predecessor on the path
             std::tie(k2, prev2, b2) = bq[prev1];
-            (*k1)                   = *k2;
+            tab.versions.lock(b2);
+            (*k1) = *k2;
+            tab.versions.unlock(b2);
 
             k0    = k1;
             k1    = k2;
@@ -26,7 +26,8 @@ class dis_deterministic_walk_optimistic
   private:
     using key_type     = typename Parent::key_type;
     using mapped_type  = typename Parent::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename dysect::element_traits<key_type, mapped_type>::value_intern;
 
     using parent_type = Parent;
     using hashed_type = typename Parent::hashed_type;
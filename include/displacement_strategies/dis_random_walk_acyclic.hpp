@@ -28,7 +28,8 @@ class dis_random_walk_acyclic
   private:
     using key_type     = typename Parent::key_type;
     using mapped_type  = typename Parent::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
     using parent_type = Parent;
     using hashed_type = typename Parent::hashed_type;
@@ -53,7 +54,7 @@ class dis_random_walk_acyclic
     }
 
     inline std::pair<int, value_intern*>
-    insert(std::pair<key_type, mapped_type> t, hashed_type hash)
+    insert(value_intern t, hashed_type hash)
     {
 
         std::vector<std::pair<value_intern, bucket_type*> > queue;
@@ -98,7 +99,7 @@ class dis_random_walk_acyclic
         {
             std::tie(tp, tb) = queue[i];
             if (!queue[i - 1].second->remove(tp.first) ||
-                !tb->insert(tp.first, tp.second))
+                !tb->insert(tp))
             {
                 return std::make_pair(-1, nullptr);
             }
@@ -30,7 +30,8 @@ template <class Parent> class dis_random_walk_cyclic
   private:
     using key_type     = typename Parent::key_type;
     using mapped_type  = typename Parent::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
     using parent_type = Parent;
     using hashed_type = typename Parent::hashed_type;
@@ -91,7 +92,7 @@ template <class Parent> class dis_random_walk_cyclic
         {
             std::tie(tp, tb) = queue[i];
             if (!(tb->remove(tp.first))) { std::cout << "f1" << std::endl; }
-            if (!(tb->insert(ttp.first, ttp.second)))
+            if (!(tb->insert(ttp)))
             {
                 std::cout << "f2" << std::endl;
             };
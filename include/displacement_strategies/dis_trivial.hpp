@@ -27,11 +27,14 @@ template <class Parent> class dis_trivial
   private:
     using key_type     = typename Parent::key_type;
     using mapped_type  = typename Parent::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
 
     using hashed_type = typename Parent::hashed_type;
 
   public:
+    static constexpr bool copy_before_clear = true;
+
     dis_trivial(Parent&, size_t, size_t) {}
     dis_trivial(Parent&, dis_trivial&&) {}
 
@@ -0,0 +1,64 @@
+#pragma once
+
+/*******************************************************************************
+ * include/element_traits.hpp
+ *
+ * element_traits defines how elements are stored inside of a table
+ * and how they are presented to the user.  Usually this is a
+ * std::pair of key and mapped data.  Tables with mapped_type void
+ * are sets, their slots only contain the key (wrapped in key_only,
+ * which has the same layout as the key itself), therefore, twice as
+ * many keys fit into each cache line.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace dysect
+{
+
+// slot type of set tables, .first is used (like in std::pair) to
+// access the key, this way all key-based code works for both variants
+template <class K> struct key_only
+{
+    K first;
+
+    key_only() : first() {}
+    key_only(const K& k) : first(k) {}
+};
+
+template <class K, class D> struct element_traits
+{
+    static constexpr bool is_set = false;
+
+    using value_intern = std::pair<K, D>;
+    using value_table  = std::pair<const K, D>;
+
+    static inline const K& key(const value_table& e) { return e.first; }
+};
+
+template <class K> struct element_traits<K, void>
+{
+    static constexpr bool is_set = true;
+
+    using value_intern = key_only<K>;
+    using value_table  = const K;
+
+    static inline const K& key(const value_table& e) { return e; }
+};
+
+static_assert(sizeof(key_only<size_t>) == sizeof(size_t),
+              "key_only has to have the same layout as its key");
+
+// used to disable functions that need mapped data on set tables
+template <class M, class T>
+using enable_if_mapped = typename std::enable_if<!std::is_void<M>::value, T>::type;
+
+} // namespace dysect
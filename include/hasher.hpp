@@ -17,6 +17,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 
 namespace dysect
 {
@@ -31,6 +33,23 @@ template <size_t t_w, bool dpair> struct hash_value_splitter;
 template <class Hashed, size_t tab_width, bool dpair, bool lcomb>
 class hash_value_extractor;
 
+// hash functions with a member hash4(const uint64_t*, uint64_t*) hash
+// four 64-bit keys at once (see integer_hash.hpp)
+template <class Key, class HFct, class = void>
+struct has_hash4 : std::false_type
+{
+};
+
+template <class Key, class HFct>
+struct has_hash4<Key, HFct,
+                 std::void_t<decltype(std::declval<const HFct&>().hash4(
+                     std::declval<const uint64_t*>(),
+                     std::declval<uint64_t*>()))>>
+    : std::integral_constant<bool, std::is_integral<Key>::value &&
+                                       sizeof(Key) == 8>
+{
+};
+
 
 
 
@@ -69,23 +88,54 @@ class hasher
     /* hasher (itself) ********************************************************/
   private:
     hash_function_type fct[n_hfct];
+    uint64_t           seed_base;
 
   public:
-    hasher()
+    hasher(uint64_t seed = 2345745572344267838ull) : seed_base(seed)
     {
         for (size_t i = 0; i < n_hfct; ++i)
         {
-            fct[i] = hash_function_type(2345745572344267838ull +
-                                        i * 8768656543548765336ull);
+            fct[i] = hash_function_type(seed + i * 8768656543548765336ull);
         }
     }
 
+    // hash functions with new seeds (see cuckoo_dysect::rehash)
+    hasher next_seed() const
+    {
+        return hasher(seed_base * 6364136223846793005ull +
+                      1442695040888963407ull);
+    }
+    uint64_t seed() const { return seed_base; }
+
     hashed_type operator()(Key k) const
     {
         hashed_type result;
         for (size_t i = 0; i < n_hfct; ++i) { result.hash[i] = fct[i](k); }
         return result;
     }
+
+    // hashes n keys (out[i] == operator()(keys[i])), keys are hashed
+    // four at a time if the hash function has a hash4 kernel,
+    // otherwise the independent keys form the inner loop
+    void hash_batch(const Key* keys, size_t n, hashed_type* out) const
+    {
+        size_t j = 0;
+        if constexpr (has_hash4<Key, hash_function_type>::value)
+        {
+            auto     k = reinterpret_cast<const uint64_t*>(keys);
+            uint64_t tmp[4];
+            for (; j + 4 <= n; j += 4)
+            {
+                for (size_t i = 0; i < n_hfct; ++i)
+                {
+                    fct[i].hash4(k + j, tmp);
+                    for (size_t l = 0; l < 4; ++l) out[j + l].hash[i] = tmp[l];
+                }
+            }
+        }
+        for (size_t i = 0; i < n_hfct; ++i)
+            for (size_t l = j; l < n; ++l) out[l].hash[i] = fct[i](keys[l]);
+    }
 };
 
 
@@ -0,0 +1,335 @@
+#pragma once
+
+/*******************************************************************************
+ * include/indirect_table.hpp
+ *
+ * indirect_table stores the mapped data out of line.  The wrapped
+ * table only stores pairs of keys and 32-bit slot indices into a
+ * separate value_arena, the arena only stores the mapped data (keys
+ * are not duplicated).  Therefore, displacements and migrations of
+ * the wrapped table only move 12-16 bytes per element, independent
+ * of the size of the mapped type.  The arena is only touched once
+ * the key was found.
+ *
+ * The arena is allocated in fixed size chunks (no reallocation),
+ * therefore, references to stored data stay valid until they are
+ * erased.  Freed slots are reused through a free list.  Iterators
+ * walk the wrapped table and dereference to pairs of the key and a
+ * reference into the arena.  The wrapped table has to be a cuckoo_base
+ * table (erase uses cuckoo_base::pop).
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "utils/output.hpp"
+
+#include "cuckoo_base.hpp"
+#include "zero_memory.hpp"
+
+namespace otm = utils_tm::out_tm;
+
+namespace dysect
+{
+
+template <class D, size_t CHUNK_BITS = 16> class value_arena
+{
+  public:
+    using mapped_type = D;
+    using size_type   = size_t;
+    using index_type  = uint32_t;
+
+    static constexpr size_type chunk_size = 1ull << CHUNK_BITS;
+    static constexpr size_type chunk_mask = chunk_size - 1;
+
+    value_arena() : n_slots(0) {}
+
+    value_arena(const value_arena&) = delete;
+    value_arena& operator=(const value_arena&) = delete;
+
+    value_arena(value_arena&&) = default;
+    value_arena& operator=(value_arena&&) = default;
+
+    inline index_type allocate()
+    {
+        if (!free_list.empty())
+        {
+            auto idx = free_list.back();
+            free_list.pop_back();
+            return idx;
+        }
+        if (!(n_slots & chunk_mask))
+            chunks.push_back(std::make_unique<mapped_type[]>(chunk_size));
+        return index_type(n_slots++);
+    }
+
+    // the slot is reset to a default constructed value
+    inline void release(index_type idx)
+    {
+        (*this)[idx] = mapped_type();
+        free_list.push_back(idx);
+    }
+
+    // all slots are emptied, the chunks are kept
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        for (auto& c : chunks) zero_range(c.get(), c.get() + chunk_size, mode);
+        n_slots = 0;
+        free_list.clear();
+    }
+
+    inline mapped_type& operator[](index_type idx)
+    {
+        return chunks[idx >> CHUNK_BITS][idx & chunk_mask];
+    }
+    inline const mapped_type& operator[](index_type idx) const
+    {
+        return chunks[idx >> CHUNK_BITS][idx & chunk_mask];
+    }
+
+    inline size_type capacity() const { return chunks.size() * chunk_size; }
+
+  private:
+    size_type                                   n_slots;
+    std::vector<std::unique_ptr<mapped_type[]> > chunks;
+    std::vector<index_type>                     free_list;
+};
+
+
+
+
+template <template <class, class, class, class> class Table, class K, class D,
+          class HF, class Conf>
+class indirect_table
+{
+  private:
+    using this_type  = indirect_table<Table, K, D, HF, Conf>;
+    using arena_type = value_arena<D>;
+    using index_type = typename arena_type::index_type;
+    using inner_type = Table<K, index_type, HF, Conf>;
+
+    template <bool> class iterator_type;
+
+  public:
+    using size_type          = size_t;
+    using key_type           = K;
+    using mapped_type        = D;
+    using value_type         = std::pair<const key_type, mapped_type>;
+    using iterator           = iterator_type<false>;
+    using const_iterator     = iterator_type<true>;
+    using insert_return_type = std::pair<iterator, bool>;
+
+  private:
+    using value_intern = std::pair<key_type, mapped_type>;
+
+  public:
+    indirect_table(size_type cap = 0, double size_constraint = 1.1,
+                   size_type dis_steps = 256, size_type seed = 0)
+        : inner(cap, size_constraint, dis_steps, seed)
+    {
+        static_assert(
+            std::is_base_of<cuckoo_base<inner_type>, inner_type>::value,
+            "indirect_table needs a cuckoo_base table (pop)");
+    }
+
+    indirect_table(const indirect_table&) = delete;
+    indirect_table& operator=(const indirect_table&) = delete;
+
+    indirect_table(indirect_table&&) = default;
+    indirect_table& operator=(indirect_table&&) = default;
+
+  private:
+    inner_type inner;
+    arena_type arena;
+
+  public:
+    // Basic Hash Table Functionality ******************************************
+    inline iterator find(const key_type& k)
+    {
+        return iterator(this, inner.find(k));
+    }
+
+    inline const_iterator find(const key_type& k) const
+    {
+        return const_cast<this_type*>(this)->find(k);
+    }
+
+    inline insert_return_type insert(const key_type& k, const mapped_type& d)
+    {
+        return insert(std::make_pair(k, d));
+    }
+
+    inline insert_return_type insert(const value_intern& t)
+    {
+        // the key is placed with a dummy index (one probe), the slot is
+        // only allocated once the key was inserted
+        auto ins = inner.insert(t.first, index_type(0));
+
+        if (ins.second)
+        {
+            auto idx              = arena.allocate();
+            (*ins.first).second   = idx;
+            arena[idx]            = t.second;
+        }
+        return std::make_pair(iterator(this, ins.first), ins.second);
+    }
+
+    // the inner table returns the arena index of the erased key
+    inline size_type erase(const key_type& k)
+    {
+        auto r = inner.pop(k);
+        if (!r.first) return 0;
+
+        arena.release(r.second);
+        return 1;
+    }
+
+    inline int displacement(const key_type& k) const
+    {
+        return inner.displacement(k);
+    }
+
+    // Easy use Accessors for std compliance ***********************************
+    inline iterator       begin() { return iterator(this, inner.begin()); }
+    inline const_iterator begin() const { return cbegin(); }
+    inline const_iterator cbegin() const
+    {
+        return const_cast<this_type*>(this)->begin();
+    }
+    inline iterator       end() { return iterator(this, inner.end()); }
+    inline const_iterator end() const { return cend(); }
+    inline const_iterator cend() const
+    {
+        return const_cast<this_type*>(this)->end();
+    }
+
+    inline mapped_type& at(const key_type& k)
+    {
+        auto a = find(k);
+        if (a == end())
+            throw std::out_of_range("cannot find key");
+        else
+            return (*a).second;
+    }
+    inline const mapped_type& at(const key_type& k) const
+    {
+        auto a = find(k);
+        if (a == cend())
+            throw std::out_of_range("cannot find key");
+        else
+            return (*a).second;
+    }
+    inline mapped_type& operator[](const key_type& k)
+    {
+        auto t = insert(k, mapped_type());
+        return (*t.first).second;
+    }
+    inline size_type count(const key_type& k) const
+    {
+        return (inner.find(k) != inner.cend()) ? 1 : 0;
+    }
+
+    // Global fill state *******************************************************
+    inline bool      empty() const { return inner.empty(); }
+    inline size_type size() const { return inner.size(); }
+
+    // Capacity ****************************************************************
+    // the arena grows on demand and is not compacted (its indices are
+    // stored in the inner table)
+    inline void reserve(size_type k) { inner.reserve(k); }
+    inline void shrink_to_fit() { inner.shrink_to_fit(); }
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        inner.clear(mode);
+        arena.clear(mode);
+    }
+
+  public:
+    inline static void print_init_header(otm::output_type& out)
+    {
+        inner_type::print_init_header(out);
+        out << otm::width(10) << "a_cap";
+    }
+
+    inline void print_init_data(otm::output_type& out)
+    {
+        inner.print_init_data(out);
+        out << otm::width(10) << arena.capacity();
+    }
+
+  private:
+    // Iterator (walks the inner table) ****************************************
+    template <bool is_const> class iterator_type
+    {
+      private:
+        using table_ptr =
+            typename std::conditional<is_const, const this_type*,
+                                      this_type*>::type;
+        using mapped_ref =
+            typename std::conditional<is_const, const mapped_type&,
+                                      mapped_type&>::type;
+        using inner_iterator = typename inner_type::iterator;
+
+      public:
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using reference         = std::pair<const key_type, mapped_ref>;
+        using value_type        = reference;
+
+        struct pointer
+        {
+            reference  ref;
+            reference* operator->() { return &ref; }
+        };
+
+        iterator_type(table_ptr table, inner_iterator it)
+            : table(table), it(it)
+        {
+        }
+        template <bool b, class = typename std::enable_if<is_const || !b>::type>
+        iterator_type(const iterator_type<b>& rhs)
+            : table(rhs.table), it(rhs.it)
+        {
+        }
+
+        iterator_type& operator++(int)
+        {
+            it++;
+            return *this;
+        }
+
+        reference operator*() const
+        {
+            return reference((*it).first, table->arena[(*it).second]);
+        }
+        pointer operator->() const { return pointer{**this}; }
+
+        bool operator==(const iterator_type& rhs) const
+        {
+            return it == rhs.it;
+        }
+        bool operator!=(const iterator_type& rhs) const
+        {
+            return it != rhs.it;
+        }
+
+      private:
+        template <bool> friend class iterator_type;
+
+        table_ptr      table;
+        inner_iterator it;
+    };
+};
+
+} // namespace dysect
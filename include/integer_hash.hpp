@@ -0,0 +1,262 @@
+#pragma once
+
+/*******************************************************************************
+ * include/integer_hash.hpp
+ *
+ * Hash functions for 64-bit integer keys.  bijective_hash is a
+ * permutation of all 64-bit values (seeded variant of the murmur3
+ * finalizer), therefore, it can be inverted.  Tables that store only
+ * parts of each hash value (see cuckoo_dysect_compact) use the
+ * inverse to reconstruct the original keys.
+ *
+ * multiply_shift_hash (2-independent) and tabulation_hash
+ * (3-independent) are cheap families for keys that are already
+ * random (e.g. 64-bit ids), fmix64_hash is bijective_hash.  All
+ * three can be used as HF of every table (DYSECT_HASHFCT MULT_SHIFT,
+ * TABULATION, FMIX64), script/hash_quality.sh compares them.
+ *
+ * All three have a hash4 member that evaluates four keys at once (AVX2,
+ * four scalar evaluations otherwise), hasher::hash_batch uses it for
+ * batched lookups and insertions.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace dysect
+{
+
+// multiplicative inverse modulo 2^64 (Newton iteration, c has to be odd)
+static constexpr uint64_t mul_inverse(uint64_t c)
+{
+    uint64_t x = c;
+    for (size_t i = 0; i < 5; ++i) x *= 2 - c * x;
+    return x;
+}
+
+// generates the random words of the seeded hash functions
+static constexpr uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+#ifdef __AVX2__
+// lane-wise 64-bit product (without AVX-512DQ it is assembled from
+// three 32x32 bit products, the high x high part does not matter mod 2^64)
+static inline __m256i simd_mul64(__m256i a, __m256i b)
+{
+#if defined(__AVX512DQ__) && defined(__AVX512VL__)
+    return _mm256_mullo_epi64(a, b);
+#else
+    __m256i lo  = _mm256_mul_epu32(a, b);
+    __m256i mid = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                   _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(mid, 32));
+#endif
+}
+
+static inline __m256i simd_xorshift(__m256i x, int s)
+{
+    return _mm256_xor_si256(x, _mm256_srli_epi64(x, s));
+}
+
+// lane-wise upper half of the 128-bit value a * b + c (for the 64-bit
+// lanes a, b and the 128-bit value c = c_hi:c_lo), from four 32x32 bit
+// products, the carries of the middle words are collected in mid
+static inline __m256i
+simd_mul_add_hi64(__m256i a, __m256i b, __m256i c_lo, __m256i c_hi)
+{
+    const __m256i lo32 = _mm256_set1_epi64x(0xffffffffll);
+    __m256i       ah   = _mm256_srli_epi64(a, 32);
+    __m256i       bh   = _mm256_srli_epi64(b, 32);
+    __m256i       ll   = _mm256_mul_epu32(a, b);
+    __m256i       lh   = _mm256_mul_epu32(a, bh);
+    __m256i       hl   = _mm256_mul_epu32(ah, b);
+    __m256i       hh   = _mm256_mul_epu32(ah, bh);
+
+    __m256i low = _mm256_add_epi64(_mm256_and_si256(ll, lo32),
+                                   _mm256_and_si256(c_lo, lo32));
+    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32),
+                                   _mm256_srli_epi64(c_lo, 32));
+    mid         = _mm256_add_epi64(mid, _mm256_and_si256(lh, lo32));
+    mid         = _mm256_add_epi64(mid, _mm256_and_si256(hl, lo32));
+    mid         = _mm256_add_epi64(mid, _mm256_srli_epi64(low, 32));
+
+    __m256i hi = _mm256_add_epi64(hh, c_hi);
+    hi         = _mm256_add_epi64(hi, _mm256_srli_epi64(lh, 32));
+    hi         = _mm256_add_epi64(hi, _mm256_srli_epi64(hl, 32));
+    return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+}
+#endif
+
+struct bijective_hash
+{
+    static constexpr std::string_view name               = "bijective";
+    static constexpr size_t           significant_digits = 64;
+
+    bijective_hash(uint64_t s = 1203989050u) : seed(s) {}
+
+    uint64_t seed;
+
+    inline uint64_t operator()(const uint64_t k) const
+    {
+        uint64_t x = k ^ seed;
+        x ^= x >> 33;
+        x *= c0;
+        x ^= x >> 33;
+        x *= c1;
+        x ^= x >> 33;
+        return x;
+    }
+
+#ifdef __AVX2__
+    inline void hash4(const uint64_t* k, uint64_t* out) const
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k));
+        x         = _mm256_xor_si256(x, _mm256_set1_epi64x(int64_t(seed)));
+        x         = simd_xorshift(x, 33);
+        x         = simd_mul64(x, _mm256_set1_epi64x(int64_t(c0)));
+        x         = simd_xorshift(x, 33);
+        x         = simd_mul64(x, _mm256_set1_epi64x(int64_t(c1)));
+        x         = simd_xorshift(x, 33);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), x);
+    }
+#else
+    inline void hash4(const uint64_t* k, uint64_t* out) const
+    {
+        for (size_t i = 0; i < 4; ++i) out[i] = operator()(k[i]);
+    }
+#endif
+
+    inline uint64_t inverse(const uint64_t h) const
+    {
+        uint64_t x = h;
+        x ^= x >> 33;
+        x *= inv_c1;
+        x ^= x >> 33;
+        x *= inv_c0;
+        x ^= x >> 33;
+        return x ^ seed;
+    }
+
+  private:
+    static constexpr uint64_t c0     = 0xff51afd7ed558ccdull;
+    static constexpr uint64_t c1     = 0xc4ceb9fe1a85ec53ull;
+    static constexpr uint64_t inv_c0 = mul_inverse(c0);
+    static constexpr uint64_t inv_c1 = mul_inverse(c1);
+
+    static_assert(c0 * inv_c0 == 1 && c1 * inv_c1 == 1,
+                  "wrong multiplicative inverse");
+};
+
+using fmix64_hash = bijective_hash;
+
+// multiply-add-shift (Dietzfelbinger): the upper half of a * k + b
+// (mod 2^128) for random 128-bit a and b, this needs one full 64x64 bit
+// product and one truncated product
+struct multiply_shift_hash
+{
+    static constexpr std::string_view name               = "multiply_shift";
+    static constexpr size_t           significant_digits = 64;
+
+    multiply_shift_hash(uint64_t s = 1203989050u)
+    {
+        a_lo = splitmix64(s);
+        a_hi = splitmix64(s);
+        b    = (static_cast<unsigned __int128>(splitmix64(s)) << 64) |
+            splitmix64(s);
+    }
+
+    inline uint64_t operator()(const uint64_t k) const
+    {
+        auto r = static_cast<unsigned __int128>(k) * a_lo + b;
+        return uint64_t(r >> 64) + k * a_hi;
+    }
+
+#ifdef __AVX2__
+    inline void hash4(const uint64_t* k, uint64_t* out) const
+    {
+        __m256i x  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k));
+        __m256i hi = simd_mul_add_hi64(
+            x, _mm256_set1_epi64x(int64_t(a_lo)),
+            _mm256_set1_epi64x(int64_t(uint64_t(b))),
+            _mm256_set1_epi64x(int64_t(uint64_t(b >> 64))));
+        hi = _mm256_add_epi64(hi,
+                              simd_mul64(x, _mm256_set1_epi64x(int64_t(a_hi))));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), hi);
+    }
+#else
+    inline void hash4(const uint64_t* k, uint64_t* out) const
+    {
+        for (size_t i = 0; i < 4; ++i) out[i] = operator()(k[i]);
+    }
+#endif
+
+  private:
+    uint64_t          a_lo;
+    uint64_t          a_hi;
+    unsigned __int128 b;
+};
+
+// simple tabulation: one table of random words per key byte, the hash
+// value is the xor of the selected words (16 KiB of tables per function)
+struct tabulation_hash
+{
+    static constexpr std::string_view name               = "tabulation";
+    static constexpr size_t           significant_digits = 64;
+
+    tabulation_hash(uint64_t s = 1203989050u)
+    {
+        for (size_t i = 0; i < 8; ++i)
+            for (size_t j = 0; j < 256; ++j) table[i][j] = splitmix64(s);
+    }
+
+    inline uint64_t operator()(const uint64_t k) const
+    {
+        uint64_t x = 0;
+        for (size_t i = 0; i < 8; ++i) x ^= table[i][(k >> (8 * i)) & 255];
+        return x;
+    }
+
+#ifdef __AVX2__
+    // one gather per key byte (the four lanes read the same table)
+    inline void hash4(const uint64_t* k, uint64_t* out) const
+    {
+        const __m256i byte = _mm256_set1_epi64x(255);
+        __m256i       x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k));
+        __m256i       r = _mm256_setzero_si256();
+        for (size_t i = 0; i < 8; ++i)
+        {
+            __m256i idx = _mm256_and_si256(_mm256_srli_epi64(x, 8 * i), byte);
+            r           = _mm256_xor_si256(
+                r, _mm256_i64gather_epi64(
+                       reinterpret_cast<const long long*>(table[i]), idx, 8));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), r);
+    }
+#else
+    inline void hash4(const uint64_t* k, uint64_t* out) const
+    {
+        for (size_t i = 0; i < 4; ++i) out[i] = operator()(k[i]);
+    }
+#endif
+
+  private:
+    uint64_t table[8][256];
+};
+
+} // namespace dysect
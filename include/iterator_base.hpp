@@ -16,6 +16,8 @@
 
 #include <tuple>
 
+#include "element_traits.hpp"
+
 namespace dysect
 {
 
@@ -26,8 +28,10 @@ template <class Increment, bool is_const = false> class iterator_base
 
     using key_type     = typename table_type::key_type;
     using mapped_type  = typename table_type::mapped_type;
-    using value_intern = std::pair<key_type, mapped_type>;
-    using value_table  = std::pair<const key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
+    using value_table =
+        typename element_traits<key_type, mapped_type>::value_table;
     using cval_intern  = typename std::conditional<is_const, const value_intern,
                                                   value_intern>::type;
 
@@ -0,0 +1,120 @@
+#pragma once
+
+/*******************************************************************************
+ * include/numa_placement.hpp
+ *
+ * Placement of table memory on NUMA nodes.  Memory is bound to a node
+ * with the mbind system call (preferred policy, i.e., the kernel falls
+ * back to other nodes when the node is full), thus, no libnuma is
+ * needed.  numa_make_array binds an array before its pages are
+ * touched, numa_bind moves pages that are already resident.  Without
+ * NUMA support (or on other systems) all functions fall back to the
+ * default placement.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dysect
+{
+
+namespace numa_detail
+{
+
+// constants of <numaif.h> (which is part of libnuma)
+static constexpr int      mpol_preferred = 1;
+static constexpr unsigned mpol_mf_move   = 1u << 1;
+static constexpr size_t   max_nodes      = 1024;
+
+} // namespace numa_detail
+
+// nodes that are online, {0} if this cannot be determined
+inline std::vector<int> numa_online_nodes()
+{
+    std::vector<int> nodes;
+    std::ifstream    file("/sys/devices/system/node/online");
+    std::string      list;
+    if (file >> list)
+    {
+        // comma separated list of ranges, e.g. "0-1,4"
+        size_t pos = 0;
+        while (pos < list.size())
+        {
+            size_t end   = list.find(',', pos);
+            auto   range = list.substr(pos, end - pos);
+            size_t dash  = range.find('-');
+            int    first = std::stoi(range.substr(0, dash));
+            int    last  = (dash == std::string::npos)
+                               ? first
+                               : std::stoi(range.substr(dash + 1));
+            for (int i = first; i <= last; ++i) nodes.push_back(i);
+            pos = (end == std::string::npos) ? list.size() : end + 1;
+        }
+    }
+    if (nodes.empty()) nodes.push_back(0);
+    return nodes;
+}
+
+// binds the whole pages of [ptr, ptr+bytes) to node, resident pages are
+// moved, returns false if the memory could not be bound
+inline bool numa_bind(void* ptr, size_t bytes, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0 || size_t(node) >= numa_detail::max_nodes) return false;
+
+    size_t    mask = sysconf(_SC_PAGESIZE) - 1;
+    uintptr_t b    = reinterpret_cast<uintptr_t>(ptr);
+    uintptr_t pb   = (b + mask) & ~mask;
+    uintptr_t pe   = (b + bytes) & ~mask;
+    if (pb >= pe) return false;
+
+    constexpr size_t word = 8 * sizeof(unsigned long);
+    unsigned long    nodemask[numa_detail::max_nodes / word] = {};
+    nodemask[node / word] |= 1ul << (node % word);
+
+    return !syscall(SYS_mbind, pb, pe - pb, numa_detail::mpol_preferred,
+                    nodemask, numa_detail::max_nodes + 1,
+                    numa_detail::mpol_mf_move);
+#else
+    (void)ptr;
+    (void)bytes;
+    (void)node;
+    return false;
+#endif
+}
+
+// array of n value initialized elements on node (node < 0 is the default
+// placement), the pages are bound before the elements are constructed
+template <class T>
+inline std::unique_ptr<T[]> numa_make_array(size_t n, int node)
+{
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "numa_make_array needs trivially destructible types");
+    if (node < 0) return std::make_unique<T[]>(n);
+
+    // new T[n] has no array cookie for trivially destructible types,
+    // thus, the memory is released by delete[] (unique_ptr<T[]>)
+    T* ptr = static_cast<T*>(::operator new[](n * sizeof(T)));
+    numa_bind(ptr, n * sizeof(T), node);
+    for (size_t i = 0; i < n; ++i) new (ptr + i) T();
+    return std::unique_ptr<T[]>(ptr);
+}
+
+} // namespace dysect
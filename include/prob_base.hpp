@@ -13,7 +13,10 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <tuple>
 #include <vector>
@@ -23,6 +26,8 @@
 
 #include "bucket.hpp"
 #include "iterator_base.hpp"
+#include "simd_probe.hpp"
+#include "zero_memory.hpp"
 
 namespace otm = utils_tm::out_tm;
 
@@ -57,7 +62,9 @@ template <class SpProb> class prob_base
     using const_iterator = iterator_base<iterator_incr<this_type>, true>;
 
   private:
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
+    using simd_type = simd_probe<key_type, value_intern>;
 
   public:
     prob_base(size_type cap, double alpha)
@@ -91,16 +98,34 @@ template <class SpProb> class prob_base
     // Basic Hash Table Functionality ******************************************
     iterator                  find(const key_type& k);
     const_iterator            find(const key_type& k) const;
-    std::pair<iterator, bool> insert(const key_type& k, const mapped_type& d);
+    // on sets (mapped_type void) elements are inserted with insert(k)
+    template <class M = mapped_type>
+    std::pair<iterator, bool>
+    insert(const key_type& k, const enable_if_mapped<M, M>& d);
     std::pair<iterator, bool> insert(const value_intern& t);
     size_type                 erase(const key_type& k);
     int                       displacement(const key_type& k) const;
 
+    // Single Probe Updates (not available on sets) ****************************
+    // if k is present f(mapped) is applied in place, otherwise (k, init)
+    // is inserted; both cases use the same probing sequence; try_emplace
+    // constructs the mapped data only if k is absent (like operator[] it
+    // needs a default constructible mapped_type)
+    template <class F, class M = mapped_type>
+    enable_if_mapped<M, std::pair<iterator, bool> >
+    upsert(const key_type& k, const enable_if_mapped<M, M>& init, F&& f);
+    template <class M = mapped_type, class... Args>
+    enable_if_mapped<M, std::pair<iterator, bool> >
+    try_emplace(const key_type& k, Args&&... args);
+    template <class M = mapped_type>
+    enable_if_mapped<M, std::pair<iterator, bool> >
+    insert_or_assign(const key_type& k, const enable_if_mapped<M, M>& d);
+
     // Easy use Accessors for std compliance ***********************************
     inline iterator begin()
     {
         auto temp = make_iterator(&table[0]);
-        if (!temp->first) temp++;
+        if (!table[0].first) temp++;
         return temp;
     }
     inline const_iterator begin() const
@@ -110,7 +135,7 @@ template <class SpProb> class prob_base
     inline const_iterator cbegin() const
     {
         auto temp = make_citerator(&table[0]);
-        if (!temp->first) temp++;
+        if (!table[0].first) temp++;
         return temp;
     }
     inline iterator       end() { return make_iterator(nullptr); }
@@ -120,13 +145,47 @@ template <class SpProb> class prob_base
     }
     inline const_iterator cend() const { return make_citerator(nullptr); }
 
-    mapped_type&       at(const key_type& k);
-    const mapped_type& at(const key_type& k) const;
-    mapped_type&       operator[](const key_type& k);
-    size_type          count(const key_type& k) const;
+    template <class M = mapped_type>
+    enable_if_mapped<M, M>& at(const key_type& k);
+    template <class M = mapped_type>
+    const enable_if_mapped<M, M>& at(const key_type& k) const;
+    template <class M = mapped_type>
+    enable_if_mapped<M, M>& operator[](const key_type& k);
+    size_type               count(const key_type& k) const;
 
     size_type get_capacity() const { return capacity; }
 
+    // Capacity ****************************************************************
+    // reserve(k) resizes the table for k elements in one migration pass
+    // (if it does not fit them yet), shrink_to_fit() resizes it for the
+    // current elements, clear() removes all elements but keeps the capacity
+    // (lazy: the memory is returned to the kernel, see zero_memory.hpp)
+    void reserve(size_type k)
+    {
+        if (k > thresh) static_cast<specialized_type*>(this)->resize(k);
+    }
+    void shrink_to_fit()
+    {
+        if (size_type(n * alpha) < capacity)
+            static_cast<specialized_type*>(this)->resize(n);
+    }
+    void clear(clear_mode mode = clear_mode::lazy)
+    {
+        static_cast<specialized_type*>(this)->clear_slots(mode);
+        n = 0;
+    }
+
+    // Interleaved Lookups *****************************************************
+    // G probe sequences are in flight at once, each sequence scans one
+    // cache line, prefetches its next cache line, and yields to the next
+    // sequence (hand-written coroutine), results[i] points to the element
+    // with keys[i] (nullptr if it is not present), returns the number of
+    // found keys
+    template <size_type G = 16>
+    size_type find_interleaved(const key_type*             keys,
+                               size_type                   count,
+                               typename iterator::pointer* results);
+
   private:
     // Easy iterators **********************************************************
     inline iterator make_iterator(value_intern* pair) const
@@ -152,6 +211,59 @@ template <class SpProb> class prob_base
 
     // Private helper function *************************************************
     void propagate_remove(size_type origin);
+    std::pair<iterator, bool> insert_stable(const value_intern& t);
+
+    // default resize (static polymorph): all elements are moved into a
+    // new table sized for k elements (tables without in place migration)
+    inline void resize(size_type k)
+    {
+        specialized_type ntable(k, alpha);
+        for (size_type i = 0; i < capacity; ++i)
+            if (table[i].first) ntable.insert(table[i]);
+        *static_cast<specialized_type*>(this) = std::move(ntable);
+    }
+    // removes all elements (tables with per slot data clear it too)
+    inline void clear_slots(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+    }
+    // in place tables shrink by buffering all elements, then clearing the
+    // table, and inserting them again (after the table was resized)
+    inline std::vector<value_intern> take_elements()
+    {
+        std::vector<value_intern> buffer;
+        buffer.reserve(n);
+        for (size_type i = 0; i < capacity; ++i)
+            if (table[i].first) buffer.push_back(table[i]);
+        static_cast<specialized_type*>(this)->clear_slots(clear_mode::lazy);
+        n = 0;
+        return buffer;
+    }
+
+    // state of one suspended lookup (see find_interleaved)
+    struct probe_state
+    {
+        size_type   key;  // index into the key array
+        size_type   pos;  // next slot (before mod)
+        size_type   last; // last slot that can contain the key
+        const void* next; // prefetched before the lookup is resumed
+    };
+
+    // probing sequence of linear probing (static polymorph), probe_step
+    // returns 1 (found), -1 (not present), or 0 (continue at s.next)
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        s.pos  = h(k);
+        s.last = std::numeric_limits<size_type>::max();
+        s.next = &table[static_cast<const specialized_type*>(this)->mod(s.pos)];
+    }
+    inline int
+    probe_step(const key_type& k, probe_state& s, value_intern*& result) const;
+    static inline bool same_line(const void* a, const void* b)
+    {
+        return (reinterpret_cast<uintptr_t>(a) >> 6) ==
+               (reinterpret_cast<uintptr_t>(b) >> 6);
+    }
 
   public:
     inline static void print_init_header(otm::output_type& out)
@@ -174,16 +286,31 @@ prob_base<SpProb>::find(const key_type& k)
 {
     auto ind = h(k);
 
-    for (size_type i = ind;; ++i)
+    for (size_type i = ind;;)
     {
-        size_type ti   = static_cast<specialized_type*>(this)->mod(i);
-        auto      temp = table[ti];
+        size_type ti = static_cast<specialized_type*>(this)->mod(i);
 
+        // vectorized probe (scalar steps where the window wraps around)
+        if constexpr (simd_type::width > 1)
+        {
+            if (ti + simd_type::width <= capacity)
+            {
+                bool found = false;
+                auto off   = simd_type::scan(&table[ti], k, found);
+                if (found) return make_iterator(&table[ti + off]);
+                if (off < simd_type::width) break;
+                i += simd_type::width;
+                continue;
+            }
+        }
+
+        const auto& temp = table[ti];
         if (temp.first == 0) { break; }
         else if (temp.first == k)
         {
             return make_iterator(&table[ti]);
         }
+        ++i;
     }
     return end();
 }
@@ -194,23 +321,39 @@ prob_base<SpProb>::find(const key_type& k) const
 {
     auto ind = h(k);
 
-    for (size_type i = ind;; ++i)
+    for (size_type i = ind;;)
     {
-        size_type ti   = static_cast<const specialized_type*>(this)->mod(i);
-        auto      temp = table[ti];
+        size_type ti = static_cast<const specialized_type*>(this)->mod(i);
 
+        // vectorized probe (scalar steps where the window wraps around)
+        if constexpr (simd_type::width > 1)
+        {
+            if (ti + simd_type::width <= capacity)
+            {
+                bool found = false;
+                auto off   = simd_type::scan(&table[ti], k, found);
+                if (found) return make_citerator(&table[ti + off]);
+                if (off < simd_type::width) break;
+                i += simd_type::width;
+                continue;
+            }
+        }
+
+        const auto& temp = table[ti];
         if (temp.first == 0) { break; }
         else if (temp.first == k)
         {
             return make_citerator(&table[ti]);
         }
+        ++i;
     }
     return cend();
 }
 
 template <class SpProb>
+template <class M>
 inline std::pair<typename prob_base<SpProb>::iterator, bool>
-prob_base<SpProb>::insert(const key_type& k, const mapped_type& d)
+prob_base<SpProb>::insert(const key_type& k, const enable_if_mapped<M, M>& d)
 {
     return insert(std::make_pair(k, d));
 }
@@ -255,7 +398,7 @@ prob_base<SpProb>::erase(const key_type& k)
         else if (temp.first == k)
         {
             dec_n();
-            table[ti] = std::make_pair(0, 0);
+            table[ti] = value_intern();
             static_cast<SpProb*>(this)->propagate_remove(ti);
             return 1;
         }
@@ -283,11 +426,150 @@ inline int prob_base<SpProb>::displacement(const key_type& k) const
 }
 
 
+// Single Probe Updates ********************************************************
+// the specialized insert (e.g. robin hood) stops at a present key,
+// therefore, it is used to find the element or its insertion position;
+// an insertion can grow the table (inc_n), then the element is moved
+// and has to be found again
+
+template <class SpProb>
+inline std::pair<typename prob_base<SpProb>::iterator, bool>
+prob_base<SpProb>::insert_stable(const value_intern& t)
+{
+    auto      sp   = static_cast<specialized_type*>(this);
+    size_type tcap = capacity;
+    auto      r    = sp->insert(t.first, t.second);
+    if (!r.second || tcap == capacity) return r;
+    return std::make_pair(sp->find(t.first), true);
+}
+
+template <class SpProb>
+template <class F, class M>
+inline enable_if_mapped<M, std::pair<typename prob_base<SpProb>::iterator, bool> >
+prob_base<SpProb>::upsert(const key_type& k,
+                          const enable_if_mapped<M, M>& init,
+                          F&& f)
+{
+    auto r = insert_stable(std::make_pair(k, init));
+    if (!r.second && r.first != end()) f((*r.first).second);
+    return r;
+}
+
+template <class SpProb>
+template <class M, class... Args>
+inline enable_if_mapped<M, std::pair<typename prob_base<SpProb>::iterator, bool> >
+prob_base<SpProb>::try_emplace(const key_type& k, Args&&... args)
+{
+    // one probe places k with a default mapped placeholder, the mapped
+    // data is only constructed if k was not present
+    auto r = insert_stable(std::make_pair(k, mapped_type()));
+    if (r.second) (*r.first).second = mapped_type(std::forward<Args>(args)...);
+    return r;
+}
+
+template <class SpProb>
+template <class M>
+inline enable_if_mapped<M, std::pair<typename prob_base<SpProb>::iterator, bool> >
+prob_base<SpProb>::insert_or_assign(const key_type& k,
+                                    const enable_if_mapped<M, M>& d)
+{
+    auto r = insert_stable(std::make_pair(k, d));
+    if (!r.second && r.first != end()) (*r.first).second = d;
+    return r;
+}
+
+
+
+// Interleaved Lookups *********************************************************
+
+template <class SpProb>
+template <size_t G>
+inline typename prob_base<SpProb>::size_type
+prob_base<SpProb>::find_interleaved(const key_type*             keys,
+                                    size_type                   count,
+                                    typename iterator::pointer* results)
+{
+    using pointer = typename iterator::pointer;
+    auto sp       = static_cast<const specialized_type*>(this);
+
+    probe_state states[G];
+    size_type   active = 0;
+    size_type   next   = 0;
+    size_type   found  = 0;
+
+    for (; active < G && next < count; ++active, ++next)
+    {
+        states[active].key = next;
+        sp->probe_start(keys[next], states[active]);
+        __builtin_prefetch(states[active].next);
+    }
+
+    while (active)
+    {
+        for (size_type i = 0; i < active;)
+        {
+            auto&         s      = states[i];
+            value_intern* result = nullptr;
+            int           state  = sp->probe_step(keys[s.key], s, result);
+
+            if (state == 0)
+            {
+                __builtin_prefetch(s.next);
+                ++i;
+                continue;
+            }
+
+            results[s.key] = reinterpret_cast<pointer>(result);
+            found += (state > 0) ? 1 : 0;
+
+            if (next < count)
+            {
+                // the finished lookup is replaced by a new one
+                s.key = next++;
+                sp->probe_start(keys[s.key], s);
+                __builtin_prefetch(s.next);
+                ++i;
+            }
+            else
+                s = states[--active];
+        }
+    }
+    return found;
+}
+
+template <class SpProb>
+inline int prob_base<SpProb>::probe_step(const key_type& k,
+                                         probe_state&    s,
+                                         value_intern*&  result) const
+{
+    auto       sp   = static_cast<const specialized_type*>(this);
+    const auto line = &table[sp->mod(s.pos)];
+
+    for (; s.pos <= s.last; ++s.pos)
+    {
+        value_intern* temp = &table[sp->mod(s.pos)];
+        if (!same_line(temp, line))
+        {
+            s.next = temp;
+            return 0;
+        }
+        if (temp->first == k)
+        {
+            result = temp;
+            return 1;
+        }
+        if (temp->first == 0) return -1;
+    }
+    return -1;
+}
+
+
+
 // Accessor Implementations ****************************************************
 
 template <class SpProb>
-inline typename prob_base<SpProb>::mapped_type&
-prob_base<SpProb>::at(const key_type& k)
+template <class M>
+inline enable_if_mapped<M, M>& prob_base<SpProb>::at(const key_type& k)
 {
     auto a = static_cast<specialized_type*>(this)->find(k);
     if (a == end())
@@ -297,7 +579,8 @@ prob_base<SpProb>::at(const key_type& k)
 }
 
 template <class SpProb>
-inline const typename prob_base<SpProb>::mapped_type&
+template <class M>
+inline const enable_if_mapped<M, M>&
 prob_base<SpProb>::at(const key_type& k) const
 {
     auto a = static_cast<const specialized_type*>(this)->find(k);
@@ -308,8 +591,8 @@ prob_base<SpProb>::at(const key_type& k) const
 }
 
 template <class SpProb>
-inline typename prob_base<SpProb>::mapped_type&
-prob_base<SpProb>::operator[](const key_type& k)
+template <class M>
+inline enable_if_mapped<M, M>& prob_base<SpProb>::operator[](const key_type& k)
 {
     auto t = static_cast<specialized_type*>(this)->insert(k, mapped_type());
     return (*t.first).second;
@@ -339,7 +622,7 @@ inline void prob_base<SpProb>::propagate_remove(const size_type origin)
 
         if (temp.first == 0) break;
 
-        table[ti] = std::make_pair(0, 0);
+        table[ti] = value_intern();
         insert(temp);
     }
     n = tempn;
@@ -357,7 +640,8 @@ template <class Specialized> class iterator_incr<prob_base<Specialized> >
   private:
     using key_type    = typename table_type::key_type;
     using mapped_type = typename table_type::mapped_type;
-    using ipointer    = std::pair<const key_type, mapped_type>*;
+    using ipointer =
+        typename element_traits<key_type, mapped_type>::value_table*;
 
   public:
     iterator_incr(const table_type& table_)
@@ -372,7 +656,7 @@ template <class Specialized> class iterator_incr<prob_base<Specialized> >
     {
         while (cur < end_ptr)
         {
-            if ((++cur)->first) return cur;
+            if (element_traits<key_type, mapped_type>::key(*++cur)) return cur;
         }
         return nullptr;
     }
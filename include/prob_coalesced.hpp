@@ -1,12 +1,16 @@
 #pragma once
 
 /*******************************************************************************
- * include/prob_hops.h
+ * include/prob_coalesced.hpp
  *
- * hops_prob and hops_prob_inplace implement the hopscotch hashing
- * scheme.  The inplace variant uses memory overcommiting to resize
- * the table without full table reallocations, that would temporarily
- * violate the memory constraint.
+ * prob_coalesced and prob_coalesced_inplace implement coalesced
+ * hashing.  Each slot stores the offset to the next element of its
+ * chain (0 ends the chain), chains start at their hashed slot and are
+ * kept disjoint, an element that occupies the hashed slot of a new
+ * chain is moved to the end of its own chain.  Lookups only compare
+ * the keys of one chain.  The inplace variant uses memory overcommiting
+ * to resize the table without full table reallocations, that would
+ * temporarily violate the memory constraint.
  *
  * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
  *
@@ -15,13 +19,25 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
-#include "prob_base.hpp"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 #include "utils/default_hash.hpp"
+#include "utils/fastrange.hpp"
+#include "utils/output.hpp"
+
+#include "prob_base.hpp"
+
+namespace otm = utils_tm::out_tm;
 
 namespace dysect
 {
 
-template <class IntegerType = uint> struct coalesced_config
+// offsets are forward distances (modulo the capacity), thus the table
+// cannot have more slots than IntegerType can represent
+template <class IntegerType = uint32_t> struct coalesced_config
 {
     using integer_type = IntegerType;
 };
@@ -36,7 +52,7 @@ template <class IntegerType = uint> struct coalesced_config
 // MAIN CLASS ******************************************************************
 // *****************************************************************************
 
-template <class K, class D, class HF = hash::default_hash,
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
           class Conf = coalesced_config<> >
 class prob_coalesced
     : public prob_traits<prob_coalesced<K, D, HF, Conf> >::base_type
@@ -46,19 +62,30 @@ class prob_coalesced
     using base_type   = typename prob_traits<this_type>::base_type;
     using offset_type = typename Conf::integer_type;
 
+    static_assert(std::is_unsigned<offset_type>::value,
+                  "coalesced offsets have to be unsigned");
+
     friend base_type;
 
   public:
+    using size_type      = typename base_type::size_type;
     using key_type       = typename prob_traits<this_type>::key_type;
     using mapped_type    = typename prob_traits<this_type>::mapped_type;
     using iterator       = typename base_type::iterator;
     using const_iterator = typename base_type::const_iterator;
 
-    prob_coalesced(size_t cap = 0, double size_constraint = 1.1,
-                   size_t /*dis_steps*/ = 0, size_t /*seed*/ = 0)
-        : base_type(cap, size_constraint)
+  private:
+    using value_intern = typename base_type::value_intern;
+
+  public:
+    prob_coalesced(size_type cap = 0, double size_constraint = 1.1,
+                   size_type /*dis_steps*/ = 0, size_type /*seed*/ = 0)
+        : base_type(std::max<size_type>(cap, 500), size_constraint)
     {
-        offset_table = std::make_unique<integer_type[]>(capacity);
+        // at least one slot stays empty (the search for free slots ends)
+        thresh = std::min(thresh, capacity - 1);
+
+        offset_table = std::make_unique<offset_type[]>(capacity);
         std::fill(offset_table.get(), offset_table.get() + capacity, 0);
     }
 
@@ -73,221 +100,201 @@ class prob_coalesced
     using base_type::capacity;
     using base_type::n;
     using base_type::table;
+    using base_type::thresh;
 
     std::unique_ptr<offset_type[]> offset_table;
 
-    static constexpr size_t bitmask = (1ull << 32) - 1;
-
+    using base_type::dec_n;
     using base_type::h;
-    using base_type::inc_n;
     using base_type::make_citerator;
     using base_type::make_iterator;
 
   public:
-    // specialized functions because of Hops Hashing
+    template <class M = mapped_type>
     inline std::pair<iterator, bool>
-    insert(const key_type& k, const mapped_type& d)
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
     {
         return insert(std::make_pair(k, d));
     }
 
-    inline std::pair<iterator, bool>
-    insert(const std::pair<key_type, mapped_type>& t)
+    inline std::pair<iterator, bool> insert(const value_intern& t)
     {
-        auto ind     = h(k);
-        auto current = table[ind];
-        if (ind != h(current.first))
+        auto ind = h(t.first);
+        auto pos = ind;
+
+        if (!table[ind].first) {}
+        else if (h(table[ind].first) != ind)
         {
-            // current slot is used by another queue
-            size_t eind = ind;
-            for (;; eind = mod(eind + 1))
+            // the slot is used by another chain
+            relocate(ind);
+        }
+        else
+        {
+            for (size_type i = ind;; i = mod(i + offset_table[i]))
             {
-                if (!table[eind].first) break;
+                if (table[i].first == t.first)
+                    return std::make_pair(make_iterator(&table[i]), false);
+                if (!offset_table[i])
+                {
+                    pos             = free_slot(i);
+                    offset_table[i] = distance(i, pos);
+                    break;
+                }
             }
-            auto pind = h(table[ind].first);
-            auto next = pind;
-            do {
-                pind = next;
-                next = pind + offset_table[pind];
-            } while (next != ind);
-            offset_table[pind] = eind - pind;
-
-            table[eind]        = current;
-            offset_table[eind] = offset_table[ind];
-            table[ind]         = t;
-            offset_table[ind]  = 0;
         }
 
-        do {
-            if (temp.first == k)
-                return std::make_pair(make_iterator(&table[ind]), false);
-
-            auto offs = offset_table[ind];
-            ind += offs;
-            current = table[ind]
-        } while (offs);
+        table[pos]        = t;
+        offset_table[pos] = 0;
 
-        for (size_t i = mod(ind + 1);; i += mod(i + 1))
+        if (++n > thresh)
         {
-            auto temp = table[i];
-
-            if (temp.first == 0)
-            {
-                table[i] = t;
-                // if (i-ind > std::numeric_limits<offset_type>::max())
-                //     move some elements around
-                offset_table[ind] = i - ind;
-                return std::make_pair(make_iterator(&table[ind]), true);
-            }
+            grow();
+            return std::make_pair(find(t.first), true);
         }
-
-        // should be unreachable code
-        // (a full table leads to an infinite loop)
-        return std::make_pair(base_type::end(), false);
+        return std::make_pair(make_iterator(&table[pos]), true);
     }
 
     inline iterator find(const key_type& k)
     {
-        auto ind     = h(k);
-        auto current = table[ind];
-        if (ind != h(current.first)) return end();
-
-        do {
-            if (temp.first == k) return make_iterator(&table[ind]);
-
-            auto offs = offset_table[ind];
-            ind += offs;
-            current = table[ind];
-        } while (offs);
-
-        return base_type::end();
+        auto i = find_slot(k);
+        return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
     }
 
     inline const_iterator find(const key_type& k) const
     {
-        auto ind     = h(k);
-        auto current = table[ind];
-        if (ind != h(current.first)) return cend();
-
-        do {
-            if (temp.first == k) return make_citerator(&table[ind]);
-
-            auto offs = offset_table[ind];
-            ind += offs;
-            current = table[ind];
-        } while (offs);
-
-        return base_type::cend();
+        auto i = find_slot(k);
+        return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
     }
 
-    inline size_t erase(const key_type& k)
+    inline size_type erase(const key_type& k)
     {
-        auto ind     = h(k);
-        auto current = table[ind];
-        if (ind != h(current.first)) return cend();
-
+        auto ind  = h(k);
         auto prev = ind;
-        do {
-            auto offs = offset_table[ind];
-            if (temp.first == k)
-            {
-                auto next = ind + offs;
+        auto i    = ind;
+        for (; table[i].first != k; i = mod(i + offset_table[i]))
+        {
+            if (!offset_table[i]) return 0;
+            prev = i;
+        }
 
-                if (prev == ind)
-                {
-                    // we removed the first chain link
-                    // switch elements with next and remove next
-                    // still works for chain length 1 (prev == ind == next)
-                    table[ind] = table[next];
-                    ind        = next;
-                    offs       = offset_table[next];
-                    next       = ind + offs;
-                }
-                offset_table[prev] = (offs) ? next - prev : 0;
-                table[ind]         = std::make_pair(0, 0);
-            }
+        if (i == ind && offset_table[i])
+        {
+            // the head of a chain stays in place, its successor is
+            // moved into it
+            prev        = i;
+            i           = mod(i + offset_table[i]);
+            table[prev] = table[i];
+        }
+        offset_table[prev] =
+            (offset_table[i] && prev != i)
+                ? distance(prev, mod(i + offset_table[i]))
+                : 0;
+        table[i]        = value_intern();
+        offset_table[i] = 0;
+
+        dec_n();
+        return 1;
+    }
 
-            prev = ind;
-            mod(ind += offs);
-            current = table[ind];
-        } while (offs);
+    // position of k within its chain
+    inline int displacement(const key_type& k) const
+    {
+        int d = 0;
+        for (size_type i = h(k); table[i].first; i = mod(i + offset_table[i]))
+        {
+            if (table[i].first == k) return d;
+            if (!offset_table[i]) break;
+            ++d;
+        }
+        return -1;
+    }
 
-        return base_type::cend();
+  private:
+    inline size_type find_slot(const key_type& k) const
+    {
+        // a chain that does not start in its hashed slot cannot contain
+        // k, it is traversed anyways (this saves a hash computation)
+        for (size_type i = h(k); table[i].first; i = mod(i + offset_table[i]))
+        {
+            if (table[i].first == k) return i;
+            if (!offset_table[i]) break;
+        }
+        return capacity;
+    }
 
+    // first empty slot behind i
+    inline size_type free_slot(size_type i) const
+    {
+        for (i = mod(i + 1); table[i].first; i = mod(i + 1)) {}
+        return i;
+    }
 
-        auto ind  = h(k);
-        auto prev = ind;
-        do {
-            auto temp = table[ind];
-            auto offs = offset_table[ind];
+    // moves the element in slot ind (which belongs to another chain) to
+    // the end of its chain
+    inline void relocate(size_type ind)
+    {
+        auto prev = h(table[ind].first);
+        while (mod(prev + offset_table[prev]) != ind)
+            prev = mod(prev + offset_table[prev]);
+
+        offset_table[prev] =
+            (offset_table[ind]) ? distance(prev, mod(ind + offset_table[ind]))
+                                : 0;
+
+        auto last = prev;
+        while (offset_table[last]) last = mod(last + offset_table[last]);
+
+        auto pos           = free_slot(last);
+        table[pos]         = table[ind];
+        offset_table[pos]  = 0;
+        offset_table[last] = distance(last, pos);
+        table[ind]         = value_intern();
+    }
 
-            if (temp.first == k)
-            {
-                table[ind] = std::make_paier(0, 0);
-                if (prev == ind)
-                { // we deleted the first chain element
-                    if (offs)
-                    {
-                        auto nexti = ind + offs;
-                        auto nexte = table[nexti];
-                        auto nexto = offset_table[nexti];
-                        table[ind] = nexte;
-                        table[off] = nexto + offs;
-                    }
-                }
-                else if (offs == 0)
-                {
-                    // we deleted the last chain element
-                    offset_table[prev] = 0;
-                }
-                else
-                {
-                    offset_table[ind]  = 0;
-                    auto next          = ind + offs - prev;
-                    offset_table[prev] = next;
-                }
-                return 1;
-            }
-            prev = ind;
-            mod(ind += offs);
+    using probe_state = typename base_type::probe_state;
 
-        } while (offs);
+    // one step compares one chain element
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        s.pos  = h(k);
+        s.next = &table[s.pos];
+        __builtin_prefetch(&offset_table[s.pos]);
+    }
 
+    inline int
+    probe_step(const key_type& k, probe_state& s, value_intern*& result) const
+    {
+        if (table[s.pos].first == k)
+        {
+            result = &table[s.pos];
+            return 1;
+        }
+        if (!table[s.pos].first || !offset_table[s.pos]) return -1;
+        s.pos  = mod(s.pos + offset_table[s.pos]);
+        s.next = &table[s.pos];
+        __builtin_prefetch(&offset_table[s.pos]);
         return 0;
     }
 
-  private:
-    inline size_t index(size_t i) const
+    inline size_type index(size_type i) const
     {
         return utils_tm::fastrange64(capacity, i);
     }
-    inline size_t mod(size_t i) const
+    inline size_type mod(size_type i) const
     {
         return (i < capacity) ? i : i - capacity;
     }
-
-    inline void grow()
+    inline size_type distance(size_type from, size_type to) const
     {
-        auto ntable = this_type(n, alpha);
-
-        for (size_t i = 0; i < capacity; ++i)
-        {
-            auto current = table[i];
-            if (current.first) ntable.insert(current);
-        }
-
-        (*this) = std::move(ntable);
+        return (to >= from) ? to - from : to + capacity - from;
     }
 
-  public:
-    inline static void print_init_header(std::ostream& out)
-    {
-        base_type::print_init_header(out);
-    }
+    inline void grow() { base_type::resize(n); }
 
-    inline void print_init_data(std::ostream& out)
+    inline void clear_slots(clear_mode mode)
     {
-        base_type::print_init_data(out);
+        zero_range(table.get(), table.get() + capacity, mode);
+        zero_range(offset_table.get(), offset_table.get() + capacity, mode);
     }
 };
 
@@ -316,23 +323,23 @@ class prob_traits<prob_coalesced<K, D, HF, Conf> >
 // Same as Above, but Growing Using in Place Migration *************************
 // *****************************************************************************
 
-template <class K, class D, class HF = hash::default_hash,
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
           class Conf = coalesced_config<> >
 class prob_coalesced_inplace
     : public prob_traits<prob_coalesced_inplace<K, D, HF, Conf> >::base_type
 {
   private:
-    using this_type = prob_coalesced_inplace<K, D, HF, Conf>;
-    using base_type = typename prob_traits<this_type>::base_type;
+    using this_type   = prob_coalesced_inplace<K, D, HF, Conf>;
+    using base_type   = typename prob_traits<this_type>::base_type;
+    using offset_type = typename Conf::integer_type;
 
-    static constexpr size_t nh_size     = Conf::neighborhood_size;
-    static constexpr size_t bitset_size = (nh_size < 64) ? nh_size : 64;
-    static constexpr size_t bucket_size = (nh_size < 64) ? 1 : nh_size / 64;
-    using AugData_t                     = augment_data<bitset_size>;
+    static_assert(std::is_unsigned<offset_type>::value,
+                  "coalesced offsets have to be unsigned");
 
     friend base_type;
 
   public:
+    using size_type      = typename base_type::size_type;
     using key_type       = typename prob_traits<this_type>::key_type;
     using mapped_type    = typename prob_traits<this_type>::mapped_type;
     using iterator       = typename base_type::iterator;
@@ -341,29 +348,34 @@ class prob_coalesced_inplace
   private:
     using value_intern = typename base_type::value_intern;
 
-    static constexpr size_t max_size = 1ull << 30;
+    static constexpr size_type max_size = 16ull << 30;
+    // marks elements that were not yet moved during the migration
+    static constexpr offset_type unplaced =
+        std::numeric_limits<offset_type>::max();
 
   public:
-    prob_coalesced_inplace(size_t cap = 0, double size_constraint = 1.1,
-                           size_t /*dis_steps*/ = 0, size_t /*seed*/ = 0)
-        : base_type(0, size_constraint), nh_data(max_size, 0)
+    prob_coalesced_inplace(size_type cap = 0, double size_constraint = 1.1,
+                           size_type /*dis_steps*/ = 0, size_type /*seed*/ = 0)
+        : base_type(0, size_constraint)
     {
         value_intern* temp =
             reinterpret_cast<value_intern*>(operator new(max_size));
-        table = std::unique_ptr<value_intern[]>(temp);
+        if (temp) table = std::unique_ptr<value_intern[]>(temp);
+        offset_table = std::unique_ptr<offset_type[]>(
+            new offset_type[max_size / sizeof(value_intern)]);
 
         capacity = (cap) ? cap * alpha : 2048 * alpha;
-        capacity = capacity / bucket_size;
-        capacity = capacity * bucket_size;
         thresh   = (cap) ? cap * beta : 2048 * beta;
+        thresh   = std::min(thresh, capacity - 1);
 
         std::fill(table.get(), table.get() + capacity, value_intern());
-        nh_data.clear_init(capacity);
+        std::fill(offset_table.get(), offset_table.get() + capacity, 0);
     }
 
     prob_coalesced_inplace(const prob_coalesced_inplace&) = delete;
     prob_coalesced_inplace& operator=(const prob_coalesced_inplace&) = delete;
-    prob_coalesced_inplace(prob_coalesced_inplace&& rhs)             = default;
+
+    prob_coalesced_inplace(prob_coalesced_inplace&& rhs) = default;
     prob_coalesced_inplace& operator=(prob_coalesced_inplace&&) = default;
 
   private:
@@ -374,94 +386,252 @@ class prob_coalesced_inplace
     using base_type::table;
     using base_type::thresh;
 
-    /* TODO implement offset table */
-
-    static constexpr size_t bitmask = (1ull << 32) - 1;
+    std::unique_ptr<offset_type[]> offset_table;
 
+    using base_type::dec_n;
     using base_type::h;
-    using base_type::inc_n;
     using base_type::make_citerator;
     using base_type::make_iterator;
 
   public:
-    // specialized functions because of Hops Hashing
+    template <class M = mapped_type>
     inline std::pair<iterator, bool>
-    insert(const key_type& k, const mapped_type& d)
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
     {
         return insert(std::make_pair(k, d));
     }
 
-    inline std::pair<iterator, bool>
-    insert(const std::pair<key_type, mapped_type>& t)
+    inline std::pair<iterator, bool> insert(const value_intern& t)
     {
-        // we first have to check if t.first is already present
-        return std::make_pair(base_type::end(), false);
+        auto ind = h(t.first);
+        auto pos = ind;
+
+        if (!table[ind].first) {}
+        else if (h(table[ind].first) != ind)
+        {
+            // the slot is used by another chain
+            relocate(ind);
+        }
+        else
+        {
+            for (size_type i = ind;; i = mod(i + offset_table[i]))
+            {
+                if (table[i].first == t.first)
+                    return std::make_pair(make_iterator(&table[i]), false);
+                if (!offset_table[i])
+                {
+                    pos             = free_slot(i);
+                    offset_table[i] = distance(i, pos);
+                    break;
+                }
+            }
+        }
+
+        table[pos]        = t;
+        offset_table[pos] = 0;
+
+        if (++n > thresh)
+        {
+            grow();
+            return std::make_pair(find(t.first), true);
+        }
+        return std::make_pair(make_iterator(&table[pos]), true);
     }
 
-    inline iterator find(const key_type& k) { return base_type::end(); }
+    inline iterator find(const key_type& k)
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
+    }
 
     inline const_iterator find(const key_type& k) const
     {
-        return base_type::cend();
+        auto i = find_slot(k);
+        return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
     }
 
-    inline size_t erase(const key_type& k) { return 0; }
+    inline size_type erase(const key_type& k)
+    {
+        auto ind  = h(k);
+        auto prev = ind;
+        auto i    = ind;
+        for (; table[i].first != k; i = mod(i + offset_table[i]))
+        {
+            if (!offset_table[i]) return 0;
+            prev = i;
+        }
+
+        if (i == ind && offset_table[i])
+        {
+            // the head of a chain stays in place, its successor is
+            // moved into it
+            prev        = i;
+            i           = mod(i + offset_table[i]);
+            table[prev] = table[i];
+        }
+        offset_table[prev] =
+            (offset_table[i] && prev != i)
+                ? distance(prev, mod(i + offset_table[i]))
+                : 0;
+        table[i]        = value_intern();
+        offset_table[i] = 0;
+
+        dec_n();
+        return 1;
+    }
+
+    // position of k within its chain
+    inline int displacement(const key_type& k) const
+    {
+        int d = 0;
+        for (size_type i = h(k); table[i].first; i = mod(i + offset_table[i]))
+        {
+            if (table[i].first == k) return d;
+            if (!offset_table[i]) break;
+            ++d;
+        }
+        return -1;
+    }
 
   private:
-    inline size_t index(size_t i) const
+    inline size_type find_slot(const key_type& k) const
     {
-        return utils_tm::fastrange64(capacity, i);
+        // a chain that does not start in its hashed slot cannot contain
+        // k, it is traversed anyways (this saves a hash computation)
+        for (size_type i = h(k); table[i].first; i = mod(i + offset_table[i]))
+        {
+            if (table[i].first == k) return i;
+            if (!offset_table[i]) break;
+        }
+        return capacity;
     }
-    inline size_t mod(size_t i) const
+
+    // first empty slot behind i
+    inline size_type free_slot(size_type i) const
     {
-        return (i < capacity) ? i : i - capacity;
+        for (i = mod(i + 1); table[i].first; i = mod(i + 1)) {}
+        return i;
     }
 
-    inline void grow()
+    // moves the element in slot ind (which belongs to another chain) to
+    // the end of its chain
+    inline void relocate(size_type ind)
     {
+        auto prev = h(table[ind].first);
+        while (mod(prev + offset_table[prev]) != ind)
+            prev = mod(prev + offset_table[prev]);
+
+        offset_table[prev] =
+            (offset_table[ind]) ? distance(prev, mod(ind + offset_table[ind]))
+                                : 0;
+
+        auto last = prev;
+        while (offset_table[last]) last = mod(last + offset_table[last]);
+
+        auto pos           = free_slot(last);
+        table[pos]         = table[ind];
+        offset_table[pos]  = 0;
+        offset_table[last] = distance(last, pos);
+        table[ind]         = value_intern();
+    }
 
-        // TODO THIS METHOD IS UNTESTED
-        // There are some weird corner cases, it looks alright though
-        size_t osize = capacity;
+    using probe_state = typename base_type::probe_state;
 
-        capacity = n * alpha;
-        thresh   = n * beta;
+    // one step compares one chain element
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        s.pos  = h(k);
+        s.next = &table[s.pos];
+        __builtin_prefetch(&offset_table[s.pos]);
+    }
 
-        std::fill(table.get() + osize, table.get() + capacity, value_intern());
-        // reset all offsets
-        std::fill(offset_table.get(), offset_table.get() + capacity, 0);
+    inline int
+    probe_step(const key_type& k, probe_state& s, value_intern*& result) const
+    {
+        if (table[s.pos].first == k)
+        {
+            result = &table[s.pos];
+            return 1;
+        }
+        if (!table[s.pos].first || !offset_table[s.pos]) return -1;
+        s.pos  = mod(s.pos + offset_table[s.pos]);
+        s.next = &table[s.pos];
+        __builtin_prefetch(&offset_table[s.pos]);
+        return 0;
+    }
 
-        std::vector<value_intern> buffer;
+    inline size_type index(size_type i) const
+    {
+        return utils_tm::fastrange64(capacity, i);
+    }
+    inline size_type mod(size_type i) const
+    {
+        return (i < capacity) ? i : i - capacity;
+    }
+    inline size_type distance(size_type from, size_type to) const
+    {
+        return (to >= from) ? to - from : to + capacity - from;
+    }
 
-        n = 0;
+    inline void grow() { grow_to(n); }
 
-        for (int i = osize; i >= 0; --i)
-        {
-            auto current = table[i];
-            if (current.first)
-            {
-                table[i] = value_intern();
-                if (h(current.first) > size_t(i))
-                    insert(current);
-                else
-                    buffer.push_back(current);
-            }
-        }
-        for (auto it = buffer.begin(); it != buffer.end(); ++it)
+    // see prob_linear_inplace::resize
+    inline void resize(size_type k)
+    {
+        k = std::max<size_type>(k, 500);
+        if (size_type(k * alpha) >= capacity)
         {
-            insert(*it);
+            grow_to(k);
+            return;
         }
+        auto buffer = base_type::take_elements();
+        capacity    = k * alpha;
+        thresh      = std::min<size_type>(k * beta, capacity - 1);
+        for (auto& e : buffer) insert(e);
     }
 
-  public:
-    inline static void print_init_header(std::ostream& out)
+    inline void clear_slots(clear_mode mode)
     {
-        base_type::print_init_header(out);
+        zero_range(table.get(), table.get() + capacity, mode);
+        zero_range(offset_table.get(), offset_table.get() + capacity, mode);
     }
 
-    inline void print_init_data(std::ostream& out)
+    inline void grow_to(size_type k)
     {
-        base_type::print_init_data(out);
+        size_type ocap = capacity;
+
+        capacity = k * alpha;
+        thresh   = std::min<size_type>(k * beta, capacity - 1);
+
+        std::fill(table.get() + ocap, table.get() + capacity, value_intern());
+        std::fill(offset_table.get() + ocap, offset_table.get() + capacity, 0);
+        for (size_type i = 0; i < ocap; ++i)
+            offset_table[i] = (table[i].first) ? unplaced : 0;
+
+        std::vector<value_intern> buffer;
+
+        // chains are rebuilt from back to front, new hashed slots are
+        // mostly behind the old position of an element
+        n = 0;
+        for (size_type i = ocap; i-- > 0;)
+        {
+            if (offset_table[i] != unplaced) continue;
+
+            auto current    = table[i];
+            table[i]        = value_intern();
+            offset_table[i] = 0;
+
+            // an unplaced element in the hashed slot is moved aside
+            auto ind = h(current.first);
+            if (offset_table[ind] == unplaced)
+            {
+                buffer.push_back(table[ind]);
+                table[ind]        = value_intern();
+                offset_table[ind] = 0;
+            }
+            insert(current);
+        }
+        for (auto it = buffer.begin(); it != buffer.end(); it++) insert(*it);
     }
 };
 
@@ -0,0 +1,416 @@
+#pragma once
+
+/*******************************************************************************
+ * include/prob_concurrent.hpp
+ *
+ * prob_linear_concurrent is a concurrent variant of prob_linear
+ * (same index/mod and growing thresholds).  Keys and values are 8 byte
+ * words that are stored in 16 byte slots, insertions claim empty slots
+ * with a double word compare-and-swap, thus, a slot is never visible
+ * with a key but without its value.  There are no deletions, therefore,
+ * find never waits for other threads.
+ *
+ * The table grows by cooperative migration.  Threads that encounter a
+ * migration claim blocks of the old table and move them into the new
+ * table.  Empty slots of moved blocks are closed with a moved marker,
+ * finds that reach a marker continue in the new table.  Old tables are
+ * freed once no handle announces them (hazard pointers).
+ *
+ * Threads access the table through handles (get_handle), the key 0 is
+ * the empty key and the key ~0 is reserved for the moved marker.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "utils/default_hash.hpp"
+#include "utils/fastrange.hpp"
+
+#include "prob_base.hpp"
+
+#if !defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#error "prob_linear_concurrent needs a 16 byte compare-and-swap (-mcx16)"
+#endif
+
+namespace dysect
+{
+
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = triv_config>
+class prob_linear_concurrent
+{
+  private:
+    using this_type = prob_linear_concurrent<K, D, HF, Conf>;
+
+    static_assert(std::is_integral_v<K> && sizeof(K) == 8,
+                  "prob_linear_concurrent needs 8 byte integer keys");
+    static_assert(std::is_trivially_copyable_v<D> && sizeof(D) == 8,
+                  "prob_linear_concurrent needs 8 byte trivial values");
+
+  public:
+    using size_type        = size_t;
+    using key_type         = K;
+    using mapped_type      = D;
+    using find_return_type = std::pair<bool, mapped_type>;
+
+    class handle;
+
+    static constexpr key_type  empty_key   = 0;
+    static constexpr key_type  moved_key   = ~key_type(0);
+    static constexpr size_type max_handles = 256;
+    static constexpr size_type block_size  = 4096;
+
+    prob_linear_concurrent(size_type cap = 0, double size_constraint = 1.1,
+                           size_type /*steps*/ = 0)
+        : alpha(size_constraint), beta((size_constraint + 1.) / 2.), n(0)
+    {
+        current.store(new table_data(std::max<size_type>(cap, 500), alpha,
+                                     beta, 0));
+    }
+
+    prob_linear_concurrent(const prob_linear_concurrent&) = delete;
+    prob_linear_concurrent& operator=(const prob_linear_concurrent&) = delete;
+
+    ~prob_linear_concurrent()
+    {
+        table_data* t = current.load();
+        delete t->next.load();
+        delete t;
+        for (auto r : retired) delete r;
+    }
+
+    // at most max_handles handles can exist at the same time
+    handle get_handle() { return handle(*this); }
+
+    // not concurrently with insertions
+    inline size_type get_capacity() const { return current.load()->capacity; }
+
+  private:
+    struct alignas(16) slot
+    {
+        key_type    key;
+        mapped_type data;
+    };
+
+    struct table_data
+    {
+        table_data(size_type cap, double alpha, double beta, size_type version)
+            : capacity(cap * alpha), thresh(cap * beta), version(version),
+              slots(std::make_unique<slot[]>(capacity)), next(nullptr),
+              growing(false), next_block(0), done_blocks(0)
+        {
+            // the element count is only updated every count_batch
+            // insertions of a handle
+            count_batch = std::clamp<size_type>(
+                (capacity - thresh) / (4 * max_handles), 1, 64);
+        }
+
+        size_type               capacity;
+        size_type               thresh;
+        size_type               version;
+        size_type               count_batch;
+        std::unique_ptr<slot[]> slots;
+
+        // migration state
+        std::atomic<table_data*> next;
+        std::atomic_bool         growing;
+        std::atomic<size_type>   next_block;
+        std::atomic<size_type>   done_blocks;
+
+        inline size_type index(size_type i) const
+        {
+            return utils_tm::fastrange64(capacity, i);
+        }
+        inline size_type mod(size_type i) const
+        {
+            return (i < capacity) ? i : i - capacity;
+        }
+    };
+
+    struct alignas(64) handle_slot
+    {
+        std::atomic<table_data*> table{nullptr};
+        std::atomic_bool         used{false};
+    };
+
+    enum class insert_result
+    {
+        inserted,
+        exists,
+        moved,
+        full
+    };
+
+    double                   alpha;
+    double                   beta;
+    HF                       hasher;
+    std::atomic<size_type>   n;
+    std::atomic<table_data*> current;
+    handle_slot              handle_slots[max_handles];
+
+    std::mutex               retire_mtx;
+    std::vector<table_data*> retired;
+
+    // Slot Access *************************************************************
+    // the key is read first, on x86 (total store order) the following
+    // read of the value cannot be older than the compare-and-swap that
+    // wrote the key
+    static inline key_type load_key(const slot& s)
+    {
+        key_type k;
+        __atomic_load(&s.key, &k, __ATOMIC_ACQUIRE);
+        return k;
+    }
+    static inline mapped_type load_data(const slot& s)
+    {
+        mapped_type d;
+        __atomic_load(&s.data, &d, __ATOMIC_RELAXED);
+        return d;
+    }
+    static inline bool cas_slot(slot& s, const slot& expected,
+                                const slot& desired)
+    {
+        unsigned __int128 e, d;
+        std::memcpy(&e, &expected, sizeof(slot));
+        std::memcpy(&d, &desired, sizeof(slot));
+        return __sync_bool_compare_and_swap(
+            reinterpret_cast<unsigned __int128*>(&s), e, d);
+    }
+
+    // Operations on one Table *************************************************
+    insert_result
+    insert_in(table_data* t, const key_type& k, const mapped_type& d)
+    {
+        size_type i0 = t->index(hasher(k));
+        for (size_type i = i0; i < i0 + t->capacity; ++i)
+        {
+            slot& s = t->slots[t->mod(i)];
+            while (true)
+            {
+                key_type sk = load_key(s);
+                if (sk == k) return insert_result::exists;
+                if (sk == moved_key) return insert_result::moved;
+                if (sk != empty_key) break;
+                if (cas_slot(s, slot(), slot{k, d}))
+                    return insert_result::inserted;
+                // somebody else claimed the slot, check its key
+            }
+        }
+        return insert_result::full;
+    }
+
+    find_return_type find_in(table_data* t, const key_type& k) const
+    {
+        while (true)
+        {
+            size_type i0 = t->index(hasher(k));
+            size_type i  = i0;
+            for (; i < i0 + t->capacity; ++i)
+            {
+                const slot& s  = t->slots[t->mod(i)];
+                key_type    sk = load_key(s);
+                if (sk == k) return find_return_type(true, load_data(s));
+                if (sk == empty_key) return find_return_type(false, {});
+                if (sk == moved_key) break;
+            }
+            if (i == i0 + t->capacity) return find_return_type(false, {});
+
+            // elements that were in t are found before any moved marker
+            // (no deletions), thus, k can only be in a newer table
+            t = t->next.load(std::memory_order_acquire);
+        }
+    }
+
+    // Growing *****************************************************************
+    void start_migration(table_data* t)
+    {
+        if (t->next.load(std::memory_order_acquire)) return;
+        if (t->growing.exchange(true, std::memory_order_acq_rel))
+        {
+            while (!t->next.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            return;
+        }
+
+        size_type nn = std::max<size_type>(n.load(std::memory_order_relaxed),
+                                           t->thresh);
+        t->next.store(new table_data(nn, alpha, beta, t->version + 1),
+                      std::memory_order_release);
+    }
+
+    // helps with the migration of t, returns once t is replaced
+    void migrate(table_data* t)
+    {
+        table_data* nt     = t->next.load(std::memory_order_acquire);
+        size_type   blocks = (t->capacity + block_size - 1) / block_size;
+
+        for (size_type b = t->next_block.fetch_add(1); b < blocks;
+             b           = t->next_block.fetch_add(1))
+        {
+            size_type e = std::min((b + 1) * block_size, t->capacity);
+            for (size_type i = b * block_size; i < e; ++i)
+                migrate_slot(t->slots[i], nt);
+
+            if (t->done_blocks.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+                blocks)
+            {
+                current.store(nt);
+                retire(t);
+            }
+        }
+
+        while (current.load(std::memory_order_acquire) == t)
+            std::this_thread::yield();
+    }
+
+    void migrate_slot(slot& s, table_data* nt)
+    {
+        // closes empty slots, full slots never change
+        if (cas_slot(s, slot(), slot{moved_key, mapped_type()})) return;
+
+        slot      e{load_key(s), load_data(s)};
+        size_type i = nt->index(hasher(e.key));
+        while (load_key(nt->slots[nt->mod(i)]) != empty_key ||
+               !cas_slot(nt->slots[nt->mod(i)], slot(), e))
+            ++i;
+    }
+
+    // tables are retired in version order, a retired table is in use if
+    // it or an older table is announced (finds follow moved markers)
+    void retire(table_data* t)
+    {
+        std::lock_guard<std::mutex> lock(retire_mtx);
+        retired.push_back(t);
+
+        size_type freed = 0;
+        for (; freed < retired.size(); ++freed)
+        {
+            bool used = false;
+            for (size_type h = 0; h < max_handles; ++h)
+                used |= handle_slots[h].table.load() == retired[freed];
+            if (used) break;
+            delete retired[freed];
+        }
+        retired.erase(retired.begin(), retired.begin() + freed);
+    }
+};
+
+
+
+// Handle (one per thread) *****************************************************
+
+template <class K, class D, class HF, class Conf>
+class prob_linear_concurrent<K, D, HF, Conf>::handle
+{
+  public:
+    handle(prob_linear_concurrent& table) : table(table), local_n(0)
+    {
+        for (id = 0; id < max_handles; ++id)
+            if (!table.handle_slots[id].used.exchange(true)) return;
+        throw std::runtime_error("prob_linear_concurrent: too many handles");
+    }
+
+    handle(const handle&) = delete;
+    handle& operator=(const handle&) = delete;
+
+    handle(handle&& rhs) : table(rhs.table), id(rhs.id), local_n(rhs.local_n)
+    {
+        rhs.id = max_handles;
+    }
+
+    ~handle()
+    {
+        if (id == max_handles) return;
+        table.n.fetch_add(local_n, std::memory_order_relaxed);
+        table.handle_slots[id].used.store(false);
+    }
+
+    // returns false if k was already present
+    bool insert(const key_type& k, const mapped_type& d)
+    {
+        while (true)
+        {
+            table_data* t = protect();
+            if (t->next.load(std::memory_order_acquire))
+            {
+                table.migrate(t);
+                continue;
+            }
+
+            switch (table.insert_in(t, k, d))
+            {
+            case insert_result::inserted:
+                count(t);
+                unprotect();
+                return true;
+            case insert_result::exists:
+                unprotect();
+                return false;
+            case insert_result::full:
+                table.start_migration(t);
+                [[fallthrough]];
+            case insert_result::moved:
+                table.migrate(t);
+            }
+        }
+    }
+
+    find_return_type find(const key_type& k)
+    {
+        auto result = table.find_in(protect(), k);
+        unprotect();
+        return result;
+    }
+
+  private:
+    prob_linear_concurrent& table;
+    size_type               id;
+    size_type               local_n;
+
+    // announces the current table, it is not freed until unprotect
+    table_data* protect()
+    {
+        auto&       announced = table.handle_slots[id].table;
+        table_data* t         = table.current.load();
+        while (true)
+        {
+            announced.store(t);
+            table_data* c = table.current.load();
+            if (c == t) return t;
+            t = c;
+        }
+    }
+    void unprotect()
+    {
+        table.handle_slots[id].table.store(nullptr, std::memory_order_release);
+    }
+
+    void count(table_data* t)
+    {
+        if (++local_n < t->count_batch) return;
+        size_type nn =
+            table.n.fetch_add(local_n, std::memory_order_relaxed) + local_n;
+        local_n = 0;
+        if (nn > t->thresh)
+        {
+            table.start_migration(t);
+            table.migrate(t);
+        }
+    }
+};
+
+} // namespace dysect
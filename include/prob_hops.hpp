@@ -15,6 +15,9 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <cstdint>
+#include <type_traits>
+
 #include "utils/default_hash.hpp"
 #include "utils/output.hpp"
 
@@ -33,43 +36,49 @@ template <size_t NS = 64> struct hopscotch_config
 template <class AugmentData> class augment_data_accessor
 {
   public:
-    static constexpr size_t bitmask = AugmentData::bitmask;
-    static constexpr size_t nh_size = AugmentData::nh_size;
+    using word_type = typename AugmentData::word_type;
 
-    augment_data_accessor(size_t* data) : data(*data) {}
+    augment_data_accessor(word_type* data) : data(*data) {}
 
-    size_t& data;
+    word_type& data;
 
-    inline size_t get_neighborhood() const { return data & bitmask; }
-    inline void   set(size_t i) { data |= (1ull << i); }
-    inline void   unset(size_t i) { data &= ~(1ull << i); }
+    inline typename AugmentData::neighborhood_type get_neighborhood() const
+    {
+        return data;
+    }
+    inline void set(size_t i) { data |= (word_type(1) << i); }
+    inline void unset(size_t i) { data &= ~(word_type(1) << i); }
 };
 
 template <size_t ns> class augment_data
 {
-    using uchar = uint8_t;
-
   public:
     static_assert(ns > 0, "Augment Data cannot handle neighborhood size 0!");
-    static_assert(ns <= 64, "Augment Data cannot handle neighborhoods >64!");
-
-    static constexpr size_t bitmask =
-        (ns == 64) ? ~size_t(0) : (1ull << ns) - 1;
-    static constexpr size_t n_bytes = (ns >> 3) + ((ns & 7) ? 1 : 0);
+    static_assert(ns <= 128, "Augment Data cannot handle neighborhoods >128!");
+
+    // one aligned word per slot (the smallest one with ns bits)
+    using word_type = typename std::conditional<
+        (ns <= 8), uint8_t,
+        typename std::conditional<
+            (ns <= 16), uint16_t,
+            typename std::conditional<
+                (ns <= 32), uint32_t,
+                typename std::conditional<(ns <= 64), uint64_t,
+                                          unsigned __int128>::type>::type>::
+            type>::type;
+    using neighborhood_type =
+        typename std::conditional<(ns <= 64), uint64_t,
+                                  unsigned __int128>::type;
+
+    static constexpr size_t n_bytes = sizeof(word_type);
     static constexpr size_t nh_size = ns;
     using this_type                 = augment_data<ns>;
     using augment_accessor_type     = augment_data_accessor<this_type>;
 
     augment_data(size_t capacity, size_t initialized)
+        : init(initialized), data(new word_type[capacity])
     {
-        auto glob_n_bytes = capacity * n_bytes + 8 - n_bytes;
-        auto init_n_bytes = initialized * n_bytes + 8 - n_bytes;
-
-        auto temp = static_cast<uchar*>(operator new(glob_n_bytes));
-        data      = std::unique_ptr<uchar[]>(temp);
-
-        std::fill(data.get(), data.get() + init_n_bytes, 0);
-        init = init_n_bytes;
+        std::fill(data.get(), data.get() + initialized, 0);
     }
 
     augment_data(const augment_data&) = delete;
@@ -87,32 +96,46 @@ template <size_t ns> class augment_data
 
     inline augment_accessor_type get_accessor(size_t index)
     {
-        return augment_accessor_type(
-            reinterpret_cast<size_t*>(data.get() + index * n_bytes));
+        return augment_accessor_type(&data[index]);
     }
 
-    inline const augment_accessor_type get_caccessor(size_t index) const
+    inline neighborhood_type get_neighborhood(size_t index) const
     {
-        return augment_accessor_type(
-            reinterpret_cast<size_t*>(data.get() + index * n_bytes));
+        return data[index];
     }
 
-    inline size_t get_neighborhood(size_t index) const
+    inline void clear_init(size_t upper)
     {
-        size_t temp =
-            *reinterpret_cast<const size_t*>(data.get() + index * n_bytes);
-        return temp & bitmask;
+        std::fill(data.get(), data.get() + upper, 0);
+        init = upper;
+    }
+    inline void clear_init(size_t upper, clear_mode mode)
+    {
+        zero_range(data.get(), data.get() + upper, mode);
+        init = upper;
     }
 
-    inline void clear_init(size_t upper)
+    // neighborhoods are scanned with tzcnt (lowest) and blsr (b &= b-1)
+    static inline size_t lowest(uint64_t b) { return __builtin_ctzll(b); }
+    static inline size_t lowest(unsigned __int128 b)
+    {
+        uint64_t lo = uint64_t(b);
+        return (lo) ? __builtin_ctzll(lo)
+                    : 64 + __builtin_ctzll(uint64_t(b >> 64));
+    }
+    // bits at positions >= off
+    static inline neighborhood_type from(neighborhood_type b, size_t off)
+    {
+        return (off < ns) ? b & (~neighborhood_type(0) << off) : 0;
+    }
+    // bits at positions < off (0 < off < ns)
+    static inline neighborhood_type below(neighborhood_type b, size_t off)
     {
-        auto up_n_bytes = upper * n_bytes + 8 - n_bytes;
-        std::fill(data.get(), data.get() + up_n_bytes, 0);
-        init = up_n_bytes;
+        return b & ((neighborhood_type(1) << off) - 1);
     }
 
-    size_t                   init;
-    std::unique_ptr<uchar[]> data;
+    size_t                       init;
+    std::unique_ptr<word_type[]> data;
 };
 
 
@@ -133,9 +156,9 @@ class prob_hopscotch
     using this_type = prob_hopscotch<K, D, HF, Conf>;
     using base_type = typename prob_traits<this_type>::base_type;
 
-    static constexpr size_t nh_size =
-        (Conf::neighborhood_size <= 64) ? Conf::neighborhood_size : 64;
-    using AugData_t = augment_data<nh_size>;
+    static constexpr size_t nh_size = Conf::neighborhood_size;
+    using AugData_t                 = augment_data<nh_size>;
+    using value_intern              = typename base_type::value_intern;
 
     friend base_type;
 
@@ -147,10 +170,9 @@ class prob_hopscotch
 
     prob_hopscotch(size_t cap = 0, double size_constraint = 1.1,
                    size_t /*dis_steps*/ = 0, size_t /*seed*/ = 0)
-        : base_type(cap, size_constraint),
-          nh_data(capacity - nh_size + 1, capacity - nh_size + 1)
+        : base_type(std::max<size_t>(cap, 2 * nh_size), size_constraint),
+          nh_data(capacity, capacity)
     {
-        // factor = double(capacity-nh_size)/double(1ull << 32);
         acap = capacity - nh_size;
     }
 
@@ -165,169 +187,192 @@ class prob_hopscotch
     using base_type::capacity;
     using base_type::n;
     using base_type::table;
+    using base_type::thresh;
 
-    // double    factor;
     size_t    acap;
     AugData_t nh_data;
 
-    static constexpr size_t bitmask = (1ull << 32) - 1;
-
+    using base_type::dec_n;
     using base_type::h;
-    using base_type::inc_n;
     using base_type::make_citerator;
     using base_type::make_iterator;
 
   public:
     // specialized functions because of Hops Hashing
+    template <class M = mapped_type>
     inline std::pair<iterator, bool>
-    insert(const key_type& k, const mapped_type& d)
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
     {
         return insert(std::make_pair(k, d));
     }
 
-    inline std::pair<iterator, bool>
-    insert(const std::pair<key_type, mapped_type>& t)
+    inline std::pair<iterator, bool> insert(const value_intern& t)
     {
         // we first have to check if t.first is already present
-        size_t ind  = h(t.first);
-        auto   aug  = nh_data.get_accessor(ind);
-        size_t bits = aug.get_neighborhood();
+        size_t ind = h(t.first);
+        auto   aug = nh_data.get_accessor(ind);
 
-        for (size_t i = ind; bits; ++i, bits >>= 1)
+        for (auto bits = aug.get_neighborhood(); bits; bits &= bits - 1)
         {
-            if (!(bits & 1))
-                continue;
-            else
-            {
-                auto temp = table[i];
-                if (temp.first == t.first)
-                {
-                    return std::make_pair(make_iterator(&table[i]), false);
-                }
-            }
+            size_t i = ind + AugData_t::lowest(bits);
+            if (table[i].first == t.first)
+                return std::make_pair(make_iterator(&table[i]), false);
         }
 
-        for (size_t i = ind;; ++i)
+        for (size_t i = ind; i < capacity; ++i)
         {
-            auto temp = table[i];
-            if (temp.first == 0)
+            if (table[i].first) continue;
+
+            size_t ti = i;
+            if (ti >= ind + nh_size)
+            {
+                bool successful;
+                std::tie(successful, ti) = move_gap(i, ind + nh_size);
+                if (!successful) break;
+            }
+            table[ti] = t;
+            aug.set(ti - ind);
+            if (++n > thresh)
             {
-                size_t ti = i;
-                if (ti >= ind + nh_size)
-                {
-                    bool successful;
-                    std::tie(successful, ti) = move_gap(i, ind + nh_size);
-                    if (!successful) break;
-                }
-                table[ti] = t;
-                aug.set(ti - ind);
-                inc_n();
-                return std::make_pair(make_iterator(&table[ti]), true);
+                grow();
+                return std::make_pair(find(t.first), true);
             }
+            return std::make_pair(make_iterator(&table[ti]), true);
         }
-        return std::make_pair(base_type::end(), false);
+
+        // no free slot can be moved into the neighborhood
+        grow(true);
+        return insert(t);
     }
 
     inline iterator find(const key_type& k)
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
-
-        for (size_t i = ind; bits; ++i, bits >>= 1)
-        {
-            if (!(bits & 1)) continue;
-            auto temp = table[i];
-            if (temp.first == k) { return make_iterator(&table[i]); }
-        }
-        return base_type::end();
+        auto i = find_slot(k);
+        return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
     }
 
     inline const_iterator find(const key_type& k) const
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
-
-        for (size_t i = ind; bits; ++i, bits >>= 1)
-        {
-            if (!(bits & 1)) continue;
-            auto temp = table[i];
-            if (temp.first == k) { return make_citerator(&table[i]); }
-        }
-        return base_type::cend();
+        auto i = find_slot(k);
+        return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
     }
 
     inline size_t erase(const key_type& k)
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
+        auto i = find_slot(k);
+        if (i == capacity) return 0;
+
+        auto ind = h(k);
+        nh_data.get_accessor(ind).unset(i - ind);
+        table[i] = value_intern();
+        dec_n();
+        return 1;
+    }
+
+    inline int displacement(const key_type& k) const
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? int(i - h(k)) : -1;
+    }
+
+  private:
+    inline size_t find_slot(const key_type& k) const
+    {
+        auto ind = h(k);
+        // the first neighborhood slot is loaded with the bitmap
+        __builtin_prefetch(&table[ind]);
 
-        for (size_t i = ind; bits; ++i, bits >>= 1)
+        for (auto bits = nh_data.get_neighborhood(ind); bits; bits &= bits - 1)
         {
-            if (!(bits & 1)) continue;
-            auto tempk = table[i].first;
-            if (tempk == k)
-            {
-                nh_data.get_accessor(ind).unset(i - ind);
-                table[i] = std::make_pair(0, 0);
-                return 1;
-            }
+            size_t i = ind + AugData_t::lowest(bits);
+            if (table[i].first == k) return i;
         }
-        return 0;
+        return capacity;
     }
 
-    inline int displacement(const key_type& k) const
+    using probe_state = typename base_type::probe_state;
+
+    // the first step loads the neighborhood, then each step scans the
+    // occupied neighborhood slots of one cache line (s.last stores the
+    // next neighborhood offset, ~0 before the first step)
+    inline void probe_start(const key_type& k, probe_state& s) const
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
+        s.pos  = h(k);
+        s.last = ~size_t(0);
+        s.next = &nh_data.data[s.pos];
+    }
+
+    inline int probe_step(const key_type& k,
+                          probe_state&    s,
+                          value_intern*&  result) const
+    {
+        auto bits = nh_data.get_neighborhood(s.pos);
+        if (s.last == ~size_t(0))
+        {
+            if (!bits) return -1;
+            s.last = AugData_t::lowest(bits);
+            s.next = &table[s.pos + s.last];
+            return 0;
+        }
 
-        for (size_t i = ind; bits; ++i, bits >>= 1)
+        const auto line = &table[s.pos + s.last];
+        for (bits = AugData_t::from(bits, s.last); bits; bits &= bits - 1)
         {
-            if (!(bits & 1)) continue;
-            auto temp = table[i];
-            if (temp.first == k) { return i - ind; }
+            s.last = AugData_t::lowest(bits);
+            if (!base_type::same_line(&table[s.pos + s.last], line))
+            {
+                s.next = &table[s.pos + s.last];
+                return 0;
+            }
+            if (table[s.pos + s.last].first == k)
+            {
+                result = &table[s.pos + s.last];
+                return 1;
+            }
         }
         return -1;
     }
 
-  private:
     inline size_t index(size_t i) const
     {
         return utils_tm::fastrange64(acap, i);
     }
     inline size_t mod(size_t i) const { return i; }
 
-    inline void grow()
+    // failed (insertion failed) grows by at least a factor of beta
+    inline void grow(bool failed = false)
     {
-        auto ntable = this_type(n, alpha);
-
-        for (size_t i = 0; i < capacity; ++i)
-        {
-            auto current = table[i];
-            if (current.first) ntable.insert(current);
-        }
+        base_type::resize((failed) ? std::max<size_t>(n, thresh + 1) : n);
+    }
 
-        (*this) = std::move(ntable);
+    inline void clear_slots(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+        nh_data.clear_init(capacity, mode);
     }
 
+    // moves an element from an earlier slot into the free slot pos (the
+    // element has to stay in its neighborhood), repeats until the free
+    // slot is before goal
     inline std::pair<bool, size_t> move_gap(const size_t pos, const size_t goal)
     {
-        for (size_t i = pos - nh_size + 1; i < pos; ++i)
+        for (size_t j = pos - nh_size + 1; j < pos; ++j)
         {
-            auto current = table[i];
-            auto ind     = h(current.first);
-            if (ind + nh_size > pos)
-            {
-                auto aug = nh_data.get_accessor(ind);
-                aug.unset(i - ind);
-                aug.set(pos - ind);
-
-                table[pos] = current;
-                table[i]   = std::make_pair(0, 0);
-                if (i < goal)
-                    return std::make_pair(true, i);
-                else
-                    return move_gap(i, goal);
-            }
+            // the first element of neighborhood j that can be moved
+            auto bits = AugData_t::below(nh_data.get_neighborhood(j), pos - j);
+            if (!bits) continue;
+
+            size_t i   = j + AugData_t::lowest(bits);
+            auto   aug = nh_data.get_accessor(j);
+            aug.unset(i - j);
+            aug.set(pos - j);
+
+            table[pos] = table[i];
+            table[i]   = value_intern();
+            if (i < goal)
+                return std::make_pair(true, i);
+            else
+                return move_gap(i, goal);
         }
         return std::make_pair(false, pos);
     }
@@ -380,10 +425,8 @@ class prob_hopscotch_inplace
     using this_type = prob_hopscotch_inplace<K, D, HF, Conf>;
     using base_type = typename prob_traits<this_type>::base_type;
 
-    static constexpr size_t nh_size     = Conf::neighborhood_size;
-    static constexpr size_t bitset_size = (nh_size < 64) ? nh_size : 64;
-    static constexpr size_t bucket_size = (nh_size < 64) ? 1 : nh_size / 64;
-    using AugData_t                     = augment_data<bitset_size>;
+    static constexpr size_t nh_size = Conf::neighborhood_size;
+    using AugData_t                 = augment_data<nh_size>;
 
     friend base_type;
 
@@ -401,19 +444,17 @@ class prob_hopscotch_inplace
   public:
     prob_hopscotch_inplace(size_t cap = 0, double size_constraint = 1.1,
                            size_t /*dis_steps*/ = 0, size_t /*seed*/ = 0)
-        : base_type(0, size_constraint), nh_data(max_size, 0)
+        : base_type(0, size_constraint),
+          nh_data(max_size / sizeof(value_intern), 0), migrations(0)
     {
         value_intern* temp =
             reinterpret_cast<value_intern*>(operator new(max_size));
         table = std::unique_ptr<value_intern[]>(temp);
 
-        capacity = (cap) ? cap * alpha : 2048 * alpha;
-        capacity = capacity / bucket_size;
-        capacity = capacity * bucket_size;
+        capacity = std::max<size_t>((cap) ? cap * alpha : 2048 * alpha,
+                                    2 * nh_size);
         thresh   = (cap) ? cap * beta : 2048 * beta;
-
-        // factor = double(capacity/bucket_size-bitset_size)/double(1ull << 32);
-        acap = capacity / bucket_size - bitset_size;
+        acap     = capacity - nh_size;
 
         std::fill(table.get(), table.get() + capacity, value_intern());
         nh_data.clear_init(capacity);
@@ -432,169 +473,213 @@ class prob_hopscotch_inplace
     using base_type::table;
     using base_type::thresh;
 
-    // double    factor;
     size_t    acap;
     AugData_t nh_data;
+    size_t    migrations;
 
-    static constexpr size_t bitmask = (1ull << 32) - 1;
-
+    using base_type::dec_n;
     using base_type::h;
-    using base_type::inc_n;
     using base_type::make_citerator;
     using base_type::make_iterator;
 
   public:
     // specialized functions because of Hops Hashing
+    template <class M = mapped_type>
     inline std::pair<iterator, bool>
-    insert(const key_type& k, const mapped_type& d)
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
     {
         return insert(std::make_pair(k, d));
     }
 
-    inline std::pair<iterator, bool>
-    insert(const std::pair<key_type, mapped_type>& t)
+    inline std::pair<iterator, bool> insert(const value_intern& t)
     {
         // we first have to check if t.first is already present
-        size_t ind  = h(t.first);
-        auto   aug  = nh_data.get_accessor(ind);
-        size_t bits = aug.get_neighborhood();
+        size_t ind = h(t.first);
+        auto   aug = nh_data.get_accessor(ind);
 
-        for (size_t i = ind; bits; i += bucket_size, bits >>= 1)
+        for (auto bits = aug.get_neighborhood(); bits; bits &= bits - 1)
         {
-            if (!(bits & 1))
-                continue;
-            else
-            {
-                for (size_t ti = 0; ti < bucket_size; ++ti)
-                {
-                    auto temp = table[i + ti];
-                    if (temp.first == t.first)
-                    {
-                        return std::make_pair(make_iterator(&table[i]), false);
-                    }
-                }
-            }
+            size_t i = ind + AugData_t::lowest(bits);
+            if (table[i].first == t.first)
+                return std::make_pair(make_iterator(&table[i]), false);
         }
 
-        for (size_t i = ind;; ++i)
+        for (size_t i = ind; i < capacity; ++i)
         {
-            auto temp = table[i];
-            if (temp.first == 0)
+            if (table[i].first) continue;
+
+            size_t ti = i;
+            if (ti >= ind + nh_size)
             {
-                size_t ti = i;
-                if (ti >= ind + nh_size)
-                {
-                    bool successful;
-                    std::tie(successful, ti) = move_gap(i, ind + nh_size);
-                    if (!successful) break;
-                }
-                table[ti] = t;
-                aug.set((ti - ind) / bucket_size);
-                inc_n();
-                return std::make_pair(make_iterator(&table[ti]), true);
+                bool successful;
+                std::tie(successful, ti) = move_gap(i, ind + nh_size);
+                if (!successful) break;
             }
+            table[ti] = t;
+            aug.set(ti - ind);
+            if (++n > thresh)
+            {
+                grow();
+                return std::make_pair(find(t.first), true);
+            }
+            return std::make_pair(make_iterator(&table[ti]), true);
         }
-        return std::make_pair(base_type::end(), false);
+
+        // no free slot can be moved into the neighborhood
+        grow(true);
+        return insert(t);
     }
 
     inline iterator find(const key_type& k)
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
-
-        for (size_t i = ind; bits; i += bucket_size, bits >>= 1)
-        {
-            if (!(bits & 1)) continue;
-            for (size_t ti = 0; ti < bucket_size; ++ti)
-            {
-                auto temp = table[i + ti];
-                if (temp.first == k) { return make_iterator(&table[i + ti]); }
-            }
-        }
-        return base_type::end();
+        auto i = find_slot(k);
+        return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
     }
 
     inline const_iterator find(const key_type& k) const
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
+        auto i = find_slot(k);
+        return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
+    }
+
+    inline size_t erase(const key_type& k)
+    {
+        auto i = find_slot(k);
+        if (i == capacity) return 0;
+
+        auto ind = h(k);
+        nh_data.get_accessor(ind).unset(i - ind);
+        table[i] = value_intern();
+        dec_n();
+        return 1;
+    }
+
+    inline int displacement(const key_type& k) const
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? int(i - h(k)) : -1;
+    }
+
+  private:
+    inline size_t find_slot(const key_type& k) const
+    {
+        auto ind = h(k);
+        // the first neighborhood slot is loaded with the bitmap
+        __builtin_prefetch(&table[ind]);
 
-        for (size_t i = ind; bits; i += bucket_size, bits >>= 1)
+        for (auto bits = nh_data.get_neighborhood(ind); bits; bits &= bits - 1)
         {
-            if (!(bits & 1)) continue;
-            for (size_t ti = 0; ti < bucket_size; ++ti)
-            {
-                auto temp = table[i + ti];
-                if (temp.first == k) { return make_citerator(&table[i + ti]); }
-            }
+            size_t i = ind + AugData_t::lowest(bits);
+            if (table[i].first == k) return i;
         }
-        return base_type::cend();
+        return capacity;
     }
 
-    inline size_t erase(const key_type& k)
+    using probe_state = typename base_type::probe_state;
+
+    // the first step loads the neighborhood, then each step scans the
+    // occupied neighborhood slots of one cache line (s.last stores the
+    // next neighborhood offset, ~0 before the first step)
+    inline void probe_start(const key_type& k, probe_state& s) const
     {
-        auto   ind  = h(k);
-        size_t bits = nh_data.get_neighborhood(ind);
+        s.pos  = h(k);
+        s.last = ~size_t(0);
+        s.next = &nh_data.data[s.pos];
+    }
+
+    inline int probe_step(const key_type& k,
+                          probe_state&    s,
+                          value_intern*&  result) const
+    {
+        auto bits = nh_data.get_neighborhood(s.pos);
+        if (s.last == ~size_t(0))
+        {
+            if (!bits) return -1;
+            s.last = AugData_t::lowest(bits);
+            s.next = &table[s.pos + s.last];
+            return 0;
+        }
 
-        for (size_t i = ind; bits; i += bucket_size, bits >>= 1)
+        const auto line = &table[s.pos + s.last];
+        for (bits = AugData_t::from(bits, s.last); bits; bits &= bits - 1)
         {
-            if (!(bits & 1)) continue;
-            for (size_t ti = 0; ti < bucket_size; ++ti)
+            s.last = AugData_t::lowest(bits);
+            if (!base_type::same_line(&table[s.pos + s.last], line))
+            {
+                s.next = &table[s.pos + s.last];
+                return 0;
+            }
+            if (table[s.pos + s.last].first == k)
             {
-                auto tempk = table[i + ti].first;
-                if (tempk == k)
-                {
-                    table[i] = std::make_pair(0, 0);
-                    for (size_t tti = 0; tti < bucket_size; ++tti)
-                    {
-                        auto ttk = table[i + tti].first;
-                        if (h(ttk) == ind) return 1;
-                    }
-                    nh_data.get_accessor(ind).unset((i - ind) / bucket_size);
-                    return 1;
-                }
+                result = &table[s.pos + s.last];
+                return 1;
             }
         }
-        return 0;
+        return -1;
     }
 
-  private:
     inline size_t index(size_t i) const
     {
-        return utils_tm::fastrange64(acap, i) * bucket_size;
+        return utils_tm::fastrange64(acap, i);
     }
     inline size_t mod(size_t i) const { return i; }
 
-    inline void grow()
+    // failed (insertion failed) grows by at least a factor of beta
+    inline void grow(bool failed = false)
     {
-        size_t osize = capacity;
+        grow_to((failed) ? std::max<size_t>(n, thresh + 1) : n);
+    }
 
-        capacity = n * alpha;
-        capacity = capacity / bucket_size;
-        capacity = capacity * bucket_size;
-        thresh   = n * beta;
+    // see prob_linear_inplace::resize
+    inline void resize(size_t k)
+    {
+        if (size_t(k * alpha) >= capacity)
+        {
+            grow_to(k);
+            return;
+        }
+        auto buffer = base_type::take_elements();
+        capacity    = std::max<size_t>(k * alpha, 2 * nh_size);
+        thresh      = k * beta;
+        acap        = capacity - nh_size;
+        for (auto& e : buffer) insert(e);
+    }
+
+    inline void clear_slots(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+        nh_data.clear_init(capacity, mode);
+    }
 
-        // factor = double(capacity/bucket_size-bitset_size)/double(1ull << 32);
-        acap = capacity / bucket_size - bitset_size;
+    inline void grow_to(size_t nn)
+    {
+        size_t osize = capacity;
+
+        capacity = std::max<size_t>(nn * alpha, osize);
+        thresh   = nn * beta;
+        acap     = capacity - nh_size;
 
         std::fill(table.get() + osize, table.get() + capacity, value_intern());
         nh_data.clear_init(capacity);
 
         std::vector<value_intern> buffer;
 
-        n = 0;
+        // a failed insertion during the migration starts a new migration
+        // (of all elements in the table), which finishes this one
+        auto gen = ++migrations;
+        n        = 0;
 
-        for (int i = osize; i >= 0; --i)
+        for (size_t i = osize; i-- > 0;)
         {
             auto current = table[i];
-            if (current.first)
-            {
-                table[i] = value_intern();
-                if (h(current.first) > size_t(i))
-                    insert(current);
-                else
-                    buffer.push_back(current);
-            }
+            if (!current.first) continue;
+
+            table[i] = value_intern();
+            if (h(current.first) > i)
+                insert(current);
+            else
+                buffer.push_back(current);
+            if (gen != migrations) break;
         }
         for (auto it = buffer.begin(); it != buffer.end(); ++it)
         {
@@ -602,37 +687,28 @@ class prob_hopscotch_inplace
         }
     }
 
+    // moves an element from an earlier slot into the free slot pos (the
+    // element has to stay in its neighborhood), repeats until the free
+    // slot is before goal
     inline std::pair<bool, size_t> move_gap(const size_t pos, const size_t goal)
     {
-        for (size_t i = pos - nh_size + 1; i < pos; ++i)
+        for (size_t j = pos - nh_size + 1; j < pos; ++j)
         {
-            auto current = table[i];
-            auto ind     = h(current.first);
-            if (ind + nh_size > pos)
-            {
-                auto aug = nh_data.get_accessor(ind);
-                table[i] = std::make_pair(0, 0);
-
-                // Make sure, the same bucket does not store another element
-                // hashed to ind! Then delete the bit
-                // This is not technically correct, since it might look in the
-                // next bucket, but faster this way, and additional bits don't
-                // hurt.
-                bool other = false;
-                for (size_t ti = 0; ti < bucket_size; ++ti)
-                {
-                    if (h(table[i + ti].first) == ind) other = true;
-                }
-                if (!other) aug.unset((i - ind) / bucket_size);
-
-                aug.set((pos - ind) / bucket_size);
-
-                table[pos] = current;
-                if (i < goal)
-                    return std::make_pair(true, i);
-                else
-                    return move_gap(i, goal);
-            }
+            // the first element of neighborhood j that can be moved
+            auto bits = AugData_t::below(nh_data.get_neighborhood(j), pos - j);
+            if (!bits) continue;
+
+            size_t i   = j + AugData_t::lowest(bits);
+            auto   aug = nh_data.get_accessor(j);
+            aug.unset(i - j);
+            aug.set(pos - j);
+
+            table[pos] = table[i];
+            table[i]   = value_intern();
+            if (i < goal)
+                return std::make_pair(true, i);
+            else
+                return move_gap(i, goal);
         }
         return std::make_pair(false, pos);
     }
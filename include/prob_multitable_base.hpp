@@ -72,6 +72,20 @@ template <class K, class D, class HF, class Conf> class multitable_linear
         return tables[get_table(k)].displacement(k);
     }
 
+    // each subtable is resized for its share of the elements
+    inline void reserve(size_t k)
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].reserve(k / tl);
+    }
+    inline void shrink_to_fit()
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].shrink_to_fit();
+    }
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].clear(mode);
+    }
+
 
     inline iterator       begin() { return tables[0].begin(); }
     inline iterator       end() { return tables[0].end(); }
@@ -153,6 +167,20 @@ template <class K, class D, class HF, class Conf> class multitable_robin
         return tables[get_table(k)].displacement(k);
     }
 
+    // each subtable is resized for its share of the elements
+    inline void reserve(size_t k)
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].reserve(k / tl);
+    }
+    inline void shrink_to_fit()
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].shrink_to_fit();
+    }
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].clear(mode);
+    }
+
     inline iterator       begin() { return tables[0].begin(); }
     inline iterator       end() { return tables[0].end(); }
     inline const_iterator begin() const { return tables[0].begin(); }
@@ -236,6 +264,20 @@ template <class K, class D, class HF, class Conf> class multitable_quadratic
         return tables[get_table(k)].displacement(k);
     }
 
+    // each subtable is resized for its share of the elements
+    inline void reserve(size_t k)
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].reserve(k / tl);
+    }
+    inline void shrink_to_fit()
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].shrink_to_fit();
+    }
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        for (size_t i = 0; i < tl; ++i) tables[i].clear(mode);
+    }
+
     inline iterator       begin() { return tables[0].begin(); }
     inline iterator       end() { return tables[0].end(); }
     inline const_iterator begin() const { return tables[0].begin(); }
@@ -87,18 +87,33 @@ class prob_quadratic
         return (i < capacity) ? mod(ind + 2 * i + 1) : mod(ind + 1);
     }
 
-    // Growing *************************************************************
-    inline void grow()
+    // quadratic probing visits a new cache line in each step (s.last
+    // counts the steps)
+    using probe_state = typename base_type::probe_state;
+    inline void probe_start(const key_type& k, probe_state& s) const
     {
-        auto ntable = this_type(n, alpha);
-
-        for (size_type i = 0; i < capacity; ++i)
+        s.pos  = h(k);
+        s.last = 0;
+        s.next = &table[s.pos];
+    }
+    inline int probe_step(const key_type&                    k,
+                          probe_state&                       s,
+                          std::pair<key_type, mapped_type>*& result) const
+    {
+        auto temp = table[s.pos];
+        if (temp.first == k)
         {
-            auto temp = table[i];
-            if (temp.first) { ntable.insert(temp); }
+            result = &table[s.pos];
+            return 1;
         }
-        (*this) = std::move(ntable);
+        if (temp.first == 0) return -1;
+        s.pos  = next(s.pos, s.last++);
+        s.next = &table[s.pos];
+        return 0;
     }
+
+    // Growing *************************************************************
+    inline void grow() { base_type::resize(n); }
     // Specialized Deletion stuff ******************************************
 };
 
@@ -299,12 +314,54 @@ class prob_quadratic_inplace
         return (i < capacity) ? mod(ind + 2 * i + 1) : mod(ind + 1);
     }
 
+    // quadratic probing visits a new cache line in each step (s.last
+    // counts the steps)
+    using probe_state = typename base_type::probe_state;
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        s.pos  = h(k);
+        s.last = 0;
+        s.next = &table[s.pos];
+    }
+    inline int probe_step(const key_type&                    k,
+                          probe_state&                       s,
+                          std::pair<key_type, mapped_type>*& result) const
+    {
+        auto temp = table[s.pos];
+        if (temp.first == k)
+        {
+            result = &table[s.pos];
+            return 1;
+        }
+        if (temp.first == 0) return -1;
+        s.pos  = next(s.pos, s.last++);
+        s.next = &table[s.pos];
+        return 0;
+    }
+
   private:
     // Growing *************************************************************
-    inline void grow()
+    inline void grow() { grow_to(n); }
+
+    // see prob_linear_inplace::resize
+    inline void resize(size_type k)
+    {
+        k = std::max<size_type>(k, 500);
+        if (size_type(k * alpha) >= capacity)
+        {
+            grow_to(k);
+            return;
+        }
+        auto buffer = base_type::take_elements();
+        capacity    = k * alpha;
+        thresh      = k * beta;
+        for (auto& e : buffer) insert(e);
+    }
+
+    inline void grow_to(size_type k)
     {
-        size_type ncap    = n * alpha;
-        size_type nthresh = n * beta;
+        size_type ncap    = k * alpha;
+        size_type nthresh = k * beta;
         std::fill(table.get() + capacity, table.get() + ncap, value_intern());
 
         auto ocap = capacity;
@@ -6,7 +6,11 @@
  * robin_prob and robin_prob_inplace implement robin hood hashing, a
  * variant of linear probing.  The inplace variant uses memory
  * overcommiting to resize the table without full table reallocations,
- * that would temporarily violate the memory constraint.
+ * that would temporarily violate the memory constraint.  With
+ * robin_config<true> (the default) both store the displacement of each
+ * slot in a byte array, insert compares these bytes instead of
+ * rehashing the elements it passes, and find stops at the first slot
+ * whose element is closer to its hashed position than the key would be.
  *
  * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
  *
@@ -15,6 +19,9 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <cstdint>
+#include <type_traits>
+
 #include "utils/default_hash.hpp"
 #include "utils/output.hpp"
 
@@ -25,15 +32,301 @@ namespace otm = utils_tm::out_tm;
 namespace dysect
 {
 
+template <bool DistanceBytes = true> struct robin_config
+{
+    static constexpr bool distance_bytes = DistanceBytes;
+};
+
+// configs without distance_bytes (e.g. triv_config) store no bytes
+template <class Conf, class = void>
+struct robin_distance_bytes : std::false_type
+{
+};
+
+template <class Conf>
+struct robin_distance_bytes<Conf, std::void_t<decltype(Conf::distance_bytes)> >
+    : std::integral_constant<bool, Conf::distance_bytes>
+{
+};
+
+// *****************************************************************************
+// Robin Hood Displacements (shared by both variants) **************************
+// *****************************************************************************
+
+// CRTP helper of prob_robin and prob_robin_inplace, it keeps the
+// displacement counts and the distance bytes, and implements the robin
+// hood operations on them; the table itself is accessed through the
+// specialized type (which is derived from prob_base and this class)
+template <class SpRobin> class robin_base
+{
+  private:
+    using specialized_type = SpRobin;
+    using traits_type      = prob_traits<SpRobin>;
+
+    friend specialized_type;
+
+  public:
+    using size_type   = size_t;
+    using key_type    = typename traits_type::key_type;
+    using mapped_type = typename traits_type::mapped_type;
+    using iterator    = typename traits_type::base_type::iterator;
+
+  private:
+    using value_intern =
+        typename element_traits<key_type, mapped_type>::value_intern;
+
+    robin_base() : pdistance(0) {}
+
+    robin_base(const robin_base&) = delete;
+    robin_base& operator=(const robin_base&) = delete;
+
+    robin_base(robin_base&& rhs) = default;
+    robin_base& operator=(robin_base&&) = default;
+
+    size_type pdistance;
+
+    // number of elements per displacement (keeps pdistance exact)
+    std::vector<size_type> dcount;
+
+    // displacement + 1 of each slot (0 = empty, saturates at 255)
+    static constexpr bool use_dist =
+        robin_distance_bytes<typename traits_type::config_type>::value;
+    std::unique_ptr<uint8_t[]> dist;
+
+    inline specialized_type& sp() { return *static_cast<SpRobin*>(this); }
+    inline const specialized_type& sp() const
+    {
+        return *static_cast<const SpRobin*>(this);
+    }
+
+    // resets the displacements of the first cap slots
+    inline void clear_distances(size_type cap, clear_mode mode)
+    {
+        if constexpr (use_dist) zero_range(dist.get(), dist.get() + cap, mode);
+        std::fill(dcount.begin(), dcount.end(), 0);
+        pdistance = 0;
+    }
+
+    // robin hood insertion on distance bytes, elements with equal
+    // displacement stay in insertion order, thus passed elements are
+    // only rehashed if their byte is saturated
+    inline std::pair<iterator, bool> insert_dist(const value_intern& t)
+    {
+        auto&       table    = sp().table;
+        const auto& capacity = sp().capacity;
+
+        size_type home    = sp().h(t.first);
+        bool      placed  = false; // t was swapped into the table
+        size_type pos     = 0;     // its slot
+        auto      current = t;
+
+        for (size_type i = home;; ++i)
+        {
+            // skip the slots with larger displacement (after the first
+            // swap nearly every slot is swapped again)
+            if constexpr (distance_probe::width > 1)
+            {
+                if (!placed && i + distance_probe::width <= capacity)
+                {
+                    uint32_t  cand;
+                    size_type off = distance_probe::scan(
+                        &dist[i], dist_byte(i - home), cand);
+                    if (cand)
+                        off = std::min<size_type>(off, __builtin_ctz(cand));
+                    if (off == distance_probe::width)
+                    {
+                        i += off - 1;
+                        continue;
+                    }
+                    i += off;
+                }
+            }
+
+            const auto& temp = table[i];
+
+            uint8_t cb = dist_byte(i - home);
+            uint8_t tb = dist[i];
+
+            // a present copy of t has the same displacement byte
+            if (!placed && tb == cb && temp.first == t.first)
+            {
+                return std::make_pair(sp().make_iterator(&table[i]), false);
+            }
+            if (!tb)
+            {
+                if (i == capacity - 1) return std::make_pair(sp().end(), false);
+                table[i] = current;
+                dist[i]  = cb;
+                add_distance(i - home);
+                sp().inc_n();
+                return std::make_pair(
+                    sp().make_iterator(&table[(placed) ? pos : i]), true);
+            }
+            if (tb > cb) continue;
+
+            size_type thome = (tb < 255) ? i - (tb - 1) : sp().h(temp.first);
+            if (thome <= home) continue;
+
+            if (!placed) pos = i;
+            std::swap(table[i], current);
+            dist[i] = cb;
+            add_distance(i - home);
+            sub_distance(i - thome);
+            home   = thome;
+            placed = true;
+        }
+        return std::make_pair(sp().end(), false);
+    }
+
+    // returns the slot containing k (capacity if there is none), only
+    // slots with the displacement k would have there are compared
+    inline size_type find_dist(const key_type& k) const
+    {
+        const auto& table    = sp().table;
+        const auto& capacity = sp().capacity;
+
+        auto ind  = sp().h(k);
+        auto last = ind + pdistance;
+
+        for (size_type i = ind; i <= last;)
+        {
+            if constexpr (distance_probe::width > 1)
+            {
+                if (i + distance_probe::width <= capacity)
+                {
+                    uint32_t cand;
+                    auto     off =
+                        distance_probe::scan(&dist[i], dist_byte(i - ind), cand);
+                    for (; cand; cand &= cand - 1)
+                    {
+                        auto ti = i + __builtin_ctz(cand);
+                        if (table[ti].first == k) return ti;
+                    }
+                    if (off < distance_probe::width) break;
+                    i += distance_probe::width;
+                    continue;
+                }
+            }
+
+            auto cb = dist_byte(i - ind);
+            if (dist[i] < cb) break;
+            if (dist[i] == cb && table[i].first == k) return i;
+            ++i;
+        }
+        return capacity;
+    }
+
+    static inline uint8_t dist_byte(size_type d)
+    {
+        return (d < 254) ? d + 1 : 255;
+    }
+
+    // exact displacement of the element in slot i
+    inline size_type slot_distance(size_type i) const
+    {
+        if constexpr (use_dist)
+        {
+            if (dist[i] < 255) return dist[i] - 1;
+        }
+        return i - sp().h(sp().table[i].first);
+    }
+
+    inline void set_distance(size_type i, size_type d)
+    {
+        if constexpr (use_dist) dist[i] = dist_byte(d);
+    }
+
+    // places e (hashed to home) into slot i (empty or holding e), or in
+    // front of the elements before it that are hashed behind home; with
+    // distance bytes, ties are kept in insertion order, thus after growing
+    // the elements of one old slot can be out of order
+    inline void place_sorted(size_type i, size_type home, const value_intern& e)
+    {
+        auto& table = sp().table;
+
+        if constexpr (use_dist)
+        {
+            size_type j = i;
+            while (j > home && table[j - 1].first &&
+                   j - 1 - slot_distance(j - 1) > home)
+                --j;
+
+            if (j > home && !table[j - 1].first)
+            {
+                // e belongs into the run containing home (before slot i)
+                table[i] = value_intern();
+                dist[i]  = 0;
+                for (i = home; table[i].first; ++i) {}
+                for (j = i; j > home && j - 1 - slot_distance(j - 1) > home;
+                     --j) {}
+            }
+            for (; i > j; --i)
+            {
+                auto d   = slot_distance(i - 1);
+                table[i] = table[i - 1];
+                set_distance(i, d + 1);
+                add_distance(d + 1);
+                sub_distance(d);
+            }
+        }
+        table[i] = e;
+        set_distance(i, i - home);
+        add_distance(i - home);
+    }
+
+    // backward shift deletion, elements behind the hole move one slot
+    // closer to their hashed position (until one is at its position)
+    inline void propagate_remove(const size_type hole)
+    {
+        auto& table = sp().table;
+
+        sub_distance(slot_distance(hole));
+
+        size_type thole = hole;
+        for (size_type i = hole + 1;; ++i)
+        {
+            if (table[i].first == 0) break;
+            auto d = slot_distance(i);
+            if (d == 0) break;
+
+            table[thole] = table[i];
+            set_distance(thole, d - 1);
+            thole = i;
+            add_distance(d - 1);
+            sub_distance(d);
+        }
+        table[thole] = value_intern();
+        if constexpr (use_dist) dist[thole] = 0;
+    }
+
+    inline void add_distance(size_type d)
+    {
+        if (d >= dcount.size()) dcount.resize(d + 1, 0);
+        ++dcount[d];
+        pdistance = std::max(pdistance, d);
+    }
+
+    inline void sub_distance(size_type d)
+    {
+        --dcount[d];
+        while (pdistance && !dcount[pdistance]) --pdistance;
+    }
+};
+
+
+
 template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
-          class Conf = triv_config>
-class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
+          class Conf = robin_config<> >
+class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type,
+                   public robin_base<prob_robin<K, D, HF, Conf> >
 {
   private:
-    using this_type = prob_robin<K, D, HF, Conf>;
-    using base_type = typename prob_traits<this_type>::base_type;
+    using this_type  = prob_robin<K, D, HF, Conf>;
+    using base_type  = typename prob_traits<this_type>::base_type;
+    using robin_type = robin_base<this_type>;
 
     friend base_type;
+    friend robin_type;
 
   public:
     using size_type      = typename base_type::size_type;
@@ -42,12 +335,17 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
     using iterator       = typename base_type::iterator;
     using const_iterator = typename base_type::const_iterator;
 
+  private:
+    using value_intern = typename base_type::value_intern;
+    using simd_type    = typename base_type::simd_type;
+
+  public:
     prob_robin(size_type cap = 0, double size_constraint = 1.1,
                size_type /*dis_steps*/ = 0, size_type /*seed*/ = 0)
-        : base_type(std::max<size_type>(cap, 500), size_constraint),
-          pdistance(0)
+        : base_type(std::max<size_type>(cap, 500), size_constraint)
     {
         factor = double(capacity - 300) / double(1ull << 32);
+        if constexpr (use_dist) dist = std::make_unique<uint8_t[]>(capacity);
     }
 
     prob_robin(const prob_robin&) = delete;
@@ -63,8 +361,17 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
     using base_type::n;
     using base_type::table;
 
-    size_type pdistance;
-    double    factor;
+    double factor;
+
+    using robin_type::add_distance;
+    using robin_type::dist;
+    using robin_type::find_dist;
+    using robin_type::insert_dist;
+    using robin_type::pdistance;
+    using robin_type::place_sorted;
+    using robin_type::propagate_remove;
+    using robin_type::sub_distance;
+    using robin_type::use_dist;
 
     static constexpr size_type bitmask = (1ull << 32) - 1;
 
@@ -75,19 +382,22 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
 
   public:
     // specialized functions because of Robin Hood Hashing
+    template <class M = mapped_type>
     inline std::pair<iterator, bool>
-    insert(const key_type& k, const mapped_type& d)
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
     {
         return insert(std::make_pair(k, d));
     }
 
-    inline std::pair<iterator, bool>
-    insert(const std::pair<key_type, mapped_type>& t)
+    inline std::pair<iterator, bool> insert(const value_intern& t)
     {
+        if constexpr (use_dist) return insert_dist(t);
+
         // using doubles makes the element order independent from the capacity
         // thus growing gets even easier
-        double ind     = dindex(hasher(t.first));
-        auto   current = t;
+        double    ind     = dindex(hasher(t.first));
+        auto      current = t;
+        size_type pos     = capacity; // slot of t once it was swapped in
 
         for (size_type i = ind;; ++i)
         {
@@ -102,16 +412,19 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
                 if (i == capacity - 1)
                     return std::make_pair(base_type::end(), false);
                 table[i] = current;
+                add_distance(i - size_type(ind));
+                if (pos == capacity) pos = i;
                 inc_n();
-                pdistance = std::max<size_type>(pdistance, i - size_type(ind));
-                return std::make_pair(make_iterator(&table[i]), true);
+                return std::make_pair(make_iterator(&table[pos]), true);
             }
             double tind = dindex(hasher(temp.first));
             if (tind > ind)
             {
+                if (pos == capacity) pos = i;
                 std::swap(table[i], current);
-                pdistance = std::max<int>(pdistance, i - size_type(ind));
-                ind       = tind;
+                add_distance(i - size_type(ind));
+                sub_distance(i - size_type(tind));
+                ind = tind;
             }
         }
         return std::make_pair(base_type::end(), false);
@@ -119,40 +432,91 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
 
     inline iterator find(const key_type& k)
     {
-        auto ind = h(k);
+        if constexpr (use_dist)
+        {
+            auto i = find_dist(k);
+            return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
+        }
 
-        for (size_type i = ind; i <= ind + pdistance; ++i)
+        auto ind  = h(k);
+        auto last = ind + pdistance;
+
+        for (size_type i = ind; i <= last;)
         {
-            auto temp = table[i];
+            // vectorized probe (scalar steps at the end of the table)
+            if constexpr (simd_type::width > 1)
+            {
+                if (i + simd_type::width <= capacity)
+                {
+                    bool found = false;
+                    auto off   = simd_type::scan(&table[i], k, found);
+                    if (found) return make_iterator(&table[i + off]);
+                    if (off < simd_type::width) break;
+                    i += simd_type::width;
+                    continue;
+                }
+            }
 
+            const auto& temp = table[i];
             if (temp.first == 0) { break; }
             else if (temp.first == k)
             {
                 return make_iterator(&table[i]);
             }
+            ++i;
         }
         return base_type::end();
     }
 
     inline const_iterator find(const key_type& k) const
     {
-        auto ind = h(k);
+        if constexpr (use_dist)
+        {
+            auto i = find_dist(k);
+            return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
+        }
 
-        for (size_type i = ind; i <= ind + pdistance; ++i)
+        auto ind  = h(k);
+        auto last = ind + pdistance;
+
+        for (size_type i = ind; i <= last;)
         {
-            auto temp = table[i];
+            // vectorized probe (scalar steps at the end of the table)
+            if constexpr (simd_type::width > 1)
+            {
+                if (i + simd_type::width <= capacity)
+                {
+                    bool found = false;
+                    auto off   = simd_type::scan(&table[i], k, found);
+                    if (found) return make_citerator(&table[i + off]);
+                    if (off < simd_type::width) break;
+                    i += simd_type::width;
+                    continue;
+                }
+            }
 
+            const auto& temp = table[i];
             if (temp.first == 0) { break; }
             else if (temp.first == k)
             {
                 return make_citerator(&table[i]);
             }
+            ++i;
         }
         return base_type::cend();
     }
 
     inline size_type erase(const key_type& k)
     {
+        if constexpr (use_dist)
+        {
+            auto i = find_dist(k);
+            if (i == capacity) return 0;
+            base_type::dec_n();
+            propagate_remove(i);
+            return 1;
+        }
+
         auto ind = h(k);
 
         for (size_type i = ind; i <= ind + pdistance; ++i)
@@ -188,6 +552,16 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
     }
 
   private:
+    using probe_state = typename base_type::probe_state;
+
+    // elements are at most pdistance slots behind their hashed position
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        s.pos  = h(k);
+        s.last = s.pos + pdistance;
+        s.next = &table[s.pos];
+    }
+
     inline size_type index(size_type i) const
     {
         return double(bitmask & i) * factor;
@@ -199,9 +573,11 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
     inline size_type mod(size_type i) const { return i; }
 
 
-    inline void grow()
+    inline void grow() { resize(n); }
+
+    inline void resize(size_type k)
     {
-        auto ntable = this_type(n, alpha);
+        auto ntable = this_type(k, alpha);
 
         size_type tn        = n;
         size_type tdistance = ntable.migrate(*this);
@@ -212,39 +588,24 @@ class prob_robin : public prob_traits<prob_robin<K, D, HF, Conf> >::base_type
         pdistance = tdistance;
     }
 
+    inline void clear_slots(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+        robin_type::clear_distances(capacity, mode);
+    }
+
     inline size_type migrate(this_type& source)
     {
-        size_type distance   = 0;
         size_type target_pos = 0;
         for (size_type i = 0; i < source.capacity; ++i)
         {
             auto current = source.table[i];
             if (!current.first) continue;
-            auto hash = h(current.first);
-            if (target_pos > hash)
-                distance = std::max<size_type>(distance, target_pos - hash);
-            else
-                target_pos = hash;
-            table[target_pos++] = current;
-        }
-        return distance;
-    }
-
-    inline void propagate_remove(const size_type hole)
-    {
-        size_type thole = hole;
-        for (size_type i = hole + 1;; ++i)
-        {
-            auto temp = table[i];
-
-            if (temp.first == 0) break;
-            auto tind = h(temp.first);
-            if (tind >= i) break;
-
-            table[thole] = temp;
-            thole        = i;
+            auto hash  = h(current.first);
+            target_pos = std::max(target_pos, hash);
+            place_sorted(target_pos++, hash, current);
         }
-        table[thole] = std::make_pair(0, 0);
+        return pdistance;
     }
 
   public:
@@ -287,15 +648,18 @@ class prob_traits<prob_robin<K, D, HF, Conf> >
 // *****************************************************************************
 
 template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
-          class Conf = triv_config>
+          class Conf = robin_config<> >
 class prob_robin_inplace
-    : public prob_traits<prob_robin_inplace<K, D, HF, Conf> >::base_type
+    : public prob_traits<prob_robin_inplace<K, D, HF, Conf> >::base_type,
+      public robin_base<prob_robin_inplace<K, D, HF, Conf> >
 {
   private:
-    using this_type = prob_robin_inplace<K, D, HF, Conf>;
-    using base_type = typename prob_traits<this_type>::base_type;
+    using this_type  = prob_robin_inplace<K, D, HF, Conf>;
+    using base_type  = typename prob_traits<this_type>::base_type;
+    using robin_type = robin_base<this_type>;
 
     friend base_type;
+    friend robin_type;
 
   public:
     using size_type      = typename base_type::size_type;
@@ -306,12 +670,13 @@ class prob_robin_inplace
 
   private:
     using value_intern                  = typename base_type::value_intern;
+    using simd_type                     = typename base_type::simd_type;
     static constexpr size_type max_size = 16ull << 30;
 
   public:
     prob_robin_inplace(size_type cap = 0, double size_constraint = 1.1,
                        size_type /*dis_steps*/ = 0, size_type /*seed*/ = 0)
-        : base_type(0, size_constraint), pdistance(0)
+        : base_type(0, size_constraint)
     {
         value_intern* temp =
             reinterpret_cast<value_intern*>(operator new(max_size));
@@ -322,6 +687,13 @@ class prob_robin_inplace
         factor   = double(capacity - 300) / double(1ull << 32);
 
         std::fill(table.get(), table.get() + capacity, value_intern());
+
+        if constexpr (use_dist)
+        {
+            dist = std::unique_ptr<uint8_t[]>(
+                new uint8_t[max_size / sizeof(value_intern)]);
+            std::fill(dist.get(), dist.get() + capacity, 0);
+        }
     }
 
     prob_robin_inplace(const prob_robin_inplace&) = delete;
@@ -339,8 +711,18 @@ class prob_robin_inplace
     using base_type::table;
     using base_type::thresh;
 
-    size_type pdistance;
-    double    factor;
+    double factor;
+
+    using robin_type::add_distance;
+    using robin_type::dcount;
+    using robin_type::dist;
+    using robin_type::find_dist;
+    using robin_type::insert_dist;
+    using robin_type::pdistance;
+    using robin_type::place_sorted;
+    using robin_type::propagate_remove;
+    using robin_type::sub_distance;
+    using robin_type::use_dist;
 
     static constexpr size_type bitmask = (1ull << 32) - 1;
 
@@ -351,19 +733,22 @@ class prob_robin_inplace
 
   public:
     // specialized functions because of Robin Hood Hashing
+    template <class M = mapped_type>
     inline std::pair<iterator, bool>
-    insert(const key_type& k, const mapped_type& d)
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
     {
         return insert(std::make_pair(k, d));
     }
 
-    inline std::pair<iterator, bool>
-    insert(const std::pair<key_type, mapped_type>& t)
+    inline std::pair<iterator, bool> insert(const value_intern& t)
     {
+        if constexpr (use_dist) return insert_dist(t);
+
         // using doubles makes the element order independent from the capacity
         // thus growing gets even easier
-        double ind     = dindex(hasher(t.first));
-        auto   current = t;
+        double    ind     = dindex(hasher(t.first));
+        auto      current = t;
+        size_type pos     = capacity; // slot of t once it was swapped in
 
         for (size_type i = ind;; ++i)
         {
@@ -378,16 +763,19 @@ class prob_robin_inplace
                 if (i == capacity - 1)
                     return std::make_pair(base_type::end(), false);
                 table[i] = current;
+                add_distance(i - size_type(ind));
+                if (pos == capacity) pos = i;
                 inc_n();
-                pdistance = std::max<size_type>(pdistance, i - size_type(ind));
-                return std::make_pair(make_iterator(&table[i]), true);
+                return std::make_pair(make_iterator(&table[pos]), true);
             }
             double tind = dindex(hasher(temp.first));
             if (tind > ind)
             {
+                if (pos == capacity) pos = i;
                 std::swap(table[i], current);
-                pdistance = std::max<int>(pdistance, i - size_type(ind));
-                ind       = tind;
+                add_distance(i - size_type(ind));
+                sub_distance(i - size_type(tind));
+                ind = tind;
             }
         }
         return std::make_pair(base_type::end(), false);
@@ -395,40 +783,91 @@ class prob_robin_inplace
 
     inline iterator find(const key_type& k)
     {
-        auto ind = h(k);
+        if constexpr (use_dist)
+        {
+            auto i = find_dist(k);
+            return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
+        }
 
-        for (size_type i = ind; i <= ind + pdistance; ++i)
+        auto ind  = h(k);
+        auto last = ind + pdistance;
+
+        for (size_type i = ind; i <= last;)
         {
-            auto temp = table[i];
+            // vectorized probe (scalar steps at the end of the table)
+            if constexpr (simd_type::width > 1)
+            {
+                if (i + simd_type::width <= capacity)
+                {
+                    bool found = false;
+                    auto off   = simd_type::scan(&table[i], k, found);
+                    if (found) return make_iterator(&table[i + off]);
+                    if (off < simd_type::width) break;
+                    i += simd_type::width;
+                    continue;
+                }
+            }
 
+            const auto& temp = table[i];
             if (temp.first == 0) { break; }
             else if (temp.first == k)
             {
                 return make_iterator(&table[i]);
             }
+            ++i;
         }
         return base_type::end();
     }
 
     inline const_iterator find(const key_type& k) const
     {
-        auto ind = h(k);
+        if constexpr (use_dist)
+        {
+            auto i = find_dist(k);
+            return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
+        }
 
-        for (size_type i = ind; i <= ind + pdistance; ++i)
+        auto ind  = h(k);
+        auto last = ind + pdistance;
+
+        for (size_type i = ind; i <= last;)
         {
-            auto temp = table[i];
+            // vectorized probe (scalar steps at the end of the table)
+            if constexpr (simd_type::width > 1)
+            {
+                if (i + simd_type::width <= capacity)
+                {
+                    bool found = false;
+                    auto off   = simd_type::scan(&table[i], k, found);
+                    if (found) return make_citerator(&table[i + off]);
+                    if (off < simd_type::width) break;
+                    i += simd_type::width;
+                    continue;
+                }
+            }
 
+            const auto& temp = table[i];
             if (temp.first == 0) { break; }
             else if (temp.first == k)
             {
                 return make_citerator(&table[i]);
             }
+            ++i;
         }
         return base_type::cend();
     }
 
     inline size_type erase(const key_type& k)
     {
+        if constexpr (use_dist)
+        {
+            auto i = find_dist(k);
+            if (i == capacity) return 0;
+            base_type::dec_n();
+            propagate_remove(i);
+            return 1;
+        }
+
         auto ind = h(k);
 
         for (size_type i = ind; i <= ind + pdistance; ++i)
@@ -447,6 +886,16 @@ class prob_robin_inplace
     }
 
   private:
+    using probe_state = typename base_type::probe_state;
+
+    // elements are at most pdistance slots behind their hashed position
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        s.pos  = h(k);
+        s.last = s.pos + pdistance;
+        s.next = &table[s.pos];
+    }
+
     inline size_type index(size_type i) const
     {
         return double(bitmask & i) * factor;
@@ -457,13 +906,39 @@ class prob_robin_inplace
     }
     inline size_type mod(size_type i) const { return i; }
 
-    inline void grow()
+    inline void grow() { grow_to(n); }
+
+    // see prob_linear_inplace::resize
+    inline void resize(size_type k)
+    {
+        k = std::max<size_type>(k, 500);
+        if (size_type(k * alpha) >= capacity)
+        {
+            grow_to(k);
+            return;
+        }
+        auto buffer = base_type::take_elements();
+        capacity    = k * alpha;
+        thresh      = k * beta;
+        factor      = double(capacity - 300) / double(1ull << 32);
+        for (auto& e : buffer) insert(e);
+    }
+
+    inline void clear_slots(clear_mode mode)
     {
-        size_type ncap    = n * alpha;
-        size_type nthresh = n * beta;
+        zero_range(table.get(), table.get() + capacity, mode);
+        robin_type::clear_distances(capacity, mode);
+    }
+
+    inline void grow_to(size_type k)
+    {
+        size_type ncap    = k * alpha;
+        size_type nthresh = k * beta;
         double    nfactor = double(ncap - 300) / double(1ull << 32);
 
         std::fill(table.get() + capacity, table.get() + ncap, value_intern());
+        if constexpr (use_dist)
+            std::fill(dist.get() + capacity, dist.get() + ncap, 0);
 
         size_type ocap = capacity;
         capacity       = ncap;
@@ -503,27 +978,30 @@ class prob_robin_inplace
             while (temp.first) { std::swap(table[t++], temp); }
             pdistance = std::max<size_type>(t - i, distance);
         }
+        // the buffered elements are inserted with exact distances
+        recount_distances();
         for (auto it = buffer.begin(); it != buffer.end(); it++)
         {
             insert(*it);
         }
     }
 
-    inline void propagate_remove(const size_type hole)
+    // recomputes the displacement of each element and restores the
+    // order of hashed positions (after migration)
+    inline void recount_distances()
     {
-        size_type thole = hole;
-        for (size_type i = hole + 1;; ++i)
+        std::fill(dcount.begin(), dcount.end(), 0);
+        pdistance = 0;
+        for (size_type i = 0; i < capacity; ++i)
         {
-            auto temp = table[i];
-
-            if (temp.first == 0) break;
-            auto tind = h(temp.first);
-            if (tind >= i) break;
-
-            table[thole] = temp;
-            thole        = i;
+            if (!table[i].first)
+            {
+                if constexpr (use_dist) dist[i] = 0;
+                continue;
+            }
+            auto current = table[i];
+            place_sorted(i, h(current.first), current);
         }
-        table[thole] = std::make_pair(0, 0);
     }
 
   public:
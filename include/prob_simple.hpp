@@ -133,6 +133,10 @@ class prob_linear : public prob_traits<prob_linear<K, D, HF, Conf> >::base_type
     using key_type    = typename prob_traits<this_type>::key_type;
     using mapped_type = typename prob_traits<this_type>::mapped_type;
 
+  private:
+    using value_intern = typename base_type::value_intern;
+
+  public:
     prob_linear(size_type cap = 0, double size_constraint = 1.1,
                 size_type /*steps*/ = 0)
         : base_type(std::max<size_type>(cap, 500), size_constraint)
@@ -167,37 +171,31 @@ class prob_linear : public prob_traits<prob_linear<K, D, HF, Conf> >::base_type
     }
 
     // Growing *****************************************************************
-    inline void grow()
-    {
-        auto ntable = this_type(n, alpha);
-
-        for (size_type i = 0; i < capacity; ++i)
-        {
-            auto temp = table[i];
-            if (temp.first) { ntable.insert(temp); }
-        }
-
-        (*this) = std::move(ntable);
-    }
+    inline void grow() { base_type::resize(n); }
 
     // Specialized Deletion stuff **********************************************
 
     inline void propagate_remove(const size_type hole)
     {
+        // distances are cyclic, the probing wraps around the table end
+        auto      dist  = [this](size_type from, size_type to) {
+            return (to >= from) ? to - from : to + capacity - from;
+        };
         size_type thole = hole;
         for (size_type i = hole + 1;; ++i)
         {
-            auto temp = table[i];
+            size_type ti   = mod(i);
+            auto      temp = table[ti];
 
             if (temp.first == 0) break;
             auto tind = h(temp.first);
-            if (tind <= thole)
+            if (dist(tind, ti) >= dist(thole, ti))
             {
                 table[thole] = temp;
-                thole        = i;
+                thole        = ti;
             }
         }
-        table[thole] = std::make_pair(0, 0);
+        table[thole] = value_intern();
     }
 };
 
@@ -243,7 +241,7 @@ class prob_linear_inplace
     using mapped_type = typename prob_traits<this_type>::mapped_type;
 
   private:
-    using value_intern = std::pair<key_type, mapped_type>;
+    using value_intern = typename base_type::value_intern;
 
     static constexpr size_type max_size = 16ull << 30;
 
@@ -299,12 +297,31 @@ class prob_linear_inplace
 
   private:
     // Growing *****************************************************************
-    inline void grow()
+    inline void grow() { grow_to(n); }
+
+    // grows in place, a smaller table is refilled from a buffer of all
+    // elements (they would otherwise be overwritten during the migration)
+    inline void resize(size_type k)
+    {
+        k = std::max<size_type>(k, 500);
+        if (size_type(k * alpha) >= capacity)
+        {
+            grow_to(k);
+            return;
+        }
+        auto buffer = base_type::take_elements();
+        capacity    = k * alpha;
+        thresh      = k * beta;
+        for (auto& e : buffer) insert(e);
+    }
+
+    // migration in place to a capacity for k elements (not smaller)
+    inline void grow_to(size_type k)
     {
         // auto ntable = this_type(n, alpha);
 
-        size_type ncap    = n * alpha;
-        size_type nthresh = n * beta;
+        size_type ncap    = k * alpha;
+        size_type nthresh = k * beta;
         // double    nfactor = double(ncap-300)/double(1ull << 32);
 
         std::fill(table.get() + capacity, table.get() + ncap, value_intern());
@@ -360,13 +377,13 @@ class prob_linear_inplace
         {
             if (i == capacity)
             {
-                table[thole] = std::make_pair(0, 0);
+                table[thole] = value_intern();
                 // wrap around is hard and uncommon
                 // thus do something bad we reinsert elements from start to ...
                 for (int i = 0;; ++i)
                 {
                     auto temp = table[i];
-                    table[i]  = std::make_pair(0, 0);
+                    table[i]  = value_intern();
                     dec_n();
                     insert(temp);
                 }
@@ -382,7 +399,7 @@ class prob_linear_inplace
                 thole        = i;
             }
         }
-        table[thole] = std::make_pair(0, 0);
+        table[thole] = value_intern();
     }
 
   public:
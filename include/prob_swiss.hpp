@@ -0,0 +1,800 @@
+#pragma once
+
+/*******************************************************************************
+ * include/prob_swiss.hpp
+ *
+ * prob_swiss and prob_swiss_inplace implement a swiss table style
+ * variant of linear probing.  Each slot has a control byte (empty,
+ * deleted, or 7 bits of the hash), the table is probed in groups of 16
+ * slots whose control bytes are compared at once (SSE2).  Keys are only
+ * compared in slots whose control byte matches.  The inplace variant
+ * uses memory overcommiting, and rehashes the elements within the
+ * grown table.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include <immintrin.h>
+
+#include "utils/default_hash.hpp"
+#include "utils/fastrange.hpp"
+#include "utils/output.hpp"
+
+#include "prob_base.hpp"
+
+namespace otm = utils_tm::out_tm;
+
+namespace dysect
+{
+
+// control bytes of one group, empty and deleted slots have the high bit
+// set, full slots store 7 bits of their element's hash
+class swiss_group
+{
+  public:
+    static constexpr size_t size    = 16;
+    static constexpr int8_t empty   = -128;
+    static constexpr int8_t deleted = -2;
+
+#ifdef __SSE2__
+    explicit swiss_group(const int8_t* ctrl)
+        : v(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+    {
+    }
+
+    inline uint32_t match(int8_t fp) const
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(fp)));
+    }
+    inline uint32_t match_empty() const { return match(empty); }
+    inline uint32_t match_free() const { return _mm_movemask_epi8(v); }
+
+  private:
+    __m128i v;
+#else
+    explicit swiss_group(const int8_t* ctrl) : c(ctrl) {}
+
+    inline uint32_t match(int8_t fp) const
+    {
+        uint32_t r = 0;
+        for (size_t i = 0; i < size; ++i) r |= uint32_t(c[i] == fp) << i;
+        return r;
+    }
+    inline uint32_t match_empty() const { return match(empty); }
+    inline uint32_t match_free() const
+    {
+        uint32_t r = 0;
+        for (size_t i = 0; i < size; ++i) r |= uint32_t(c[i] < 0) << i;
+        return r;
+    }
+
+  private:
+    const int8_t* c;
+#endif
+};
+
+
+
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = triv_config>
+class prob_swiss : public prob_traits<prob_swiss<K, D, HF, Conf> >::base_type
+{
+  private:
+    using this_type = prob_swiss<K, D, HF, Conf>;
+    using base_type = typename prob_traits<this_type>::base_type;
+
+    friend base_type;
+
+  public:
+    using size_type      = typename base_type::size_type;
+    using key_type       = typename prob_traits<this_type>::key_type;
+    using mapped_type    = typename prob_traits<this_type>::mapped_type;
+    using iterator       = typename base_type::iterator;
+    using const_iterator = typename base_type::const_iterator;
+
+  private:
+    using value_intern = typename base_type::value_intern;
+
+    static constexpr size_type gsize = swiss_group::size;
+
+  public:
+    prob_swiss(size_type cap = 0, double size_constraint = 1.1,
+               size_type /*dis_steps*/ = 0, size_type /*seed*/ = 0)
+        : base_type(group_cap(std::max<size_type>(cap, 500), size_constraint),
+                    size_constraint),
+          deleted(0)
+    {
+        // the table is probed in whole groups
+        capacity &= ~(gsize - 1);
+        thresh = grow_thresh(capacity);
+        groups = capacity / gsize;
+
+        ctrl = std::make_unique<int8_t[]>(capacity);
+        std::fill(ctrl.get(), ctrl.get() + capacity, swiss_group::empty);
+    }
+
+    prob_swiss(const prob_swiss&) = delete;
+    prob_swiss& operator=(const prob_swiss&) = delete;
+
+    prob_swiss(prob_swiss&& rhs) = default;
+    prob_swiss& operator=(prob_swiss&&) = default;
+
+  private:
+    using base_type::alpha;
+    using base_type::beta;
+    using base_type::capacity;
+    using base_type::hasher;
+    using base_type::n;
+    using base_type::table;
+    using base_type::thresh;
+
+    size_type                 groups;
+    size_type                 deleted;
+    std::unique_ptr<int8_t[]> ctrl;
+
+    using base_type::dec_n;
+    using base_type::make_citerator;
+    using base_type::make_iterator;
+
+  public:
+    template <class M = mapped_type>
+    inline std::pair<iterator, bool>
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
+    {
+        return insert(std::make_pair(k, d));
+    }
+
+    inline std::pair<iterator, bool> insert(const value_intern& t)
+    {
+        auto      hash = hasher(t.first);
+        auto      fp   = fingerprint(hash);
+        size_type free = capacity;
+
+        for (size_type i = index(hash);; i = mod(i + gsize))
+        {
+            swiss_group g(&ctrl[i]);
+            for (auto m = g.match(fp); m; m &= m - 1)
+            {
+                auto ti = i + __builtin_ctz(m);
+                if (table[ti].first == t.first)
+                    return std::make_pair(make_iterator(&table[ti]), false);
+            }
+            if (free == capacity)
+            {
+                auto f = g.match_free();
+                if (f) free = i + __builtin_ctz(f);
+            }
+            if (g.match_empty()) break;
+        }
+
+        if (ctrl[free] == swiss_group::deleted) --deleted;
+        table[free] = t;
+        ctrl[free]  = fp;
+
+        // tombstones count towards the growing threshold
+        if (++n + deleted > thresh)
+        {
+            grow();
+            return std::make_pair(find(t.first), true);
+        }
+        return std::make_pair(make_iterator(&table[free]), true);
+    }
+
+    inline iterator find(const key_type& k)
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
+    }
+
+    inline const_iterator find(const key_type& k) const
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
+    }
+
+    inline size_type erase(const key_type& k)
+    {
+        auto i = find_slot(k);
+        if (i == capacity) return 0;
+
+        table[i] = value_intern();
+        // a group with an empty slot never ended a probe, thus no
+        // probing sequence continues behind it
+        if (swiss_group(&ctrl[i & ~(gsize - 1)]).match_empty())
+            ctrl[i] = swiss_group::empty;
+        else
+        {
+            ctrl[i] = swiss_group::deleted;
+            ++deleted;
+        }
+        dec_n();
+        return 1;
+    }
+
+    inline int displacement(const key_type& k) const
+    {
+        auto i = find_slot(k);
+        if (i == capacity) return -1;
+        auto home = index(hasher(k));
+        return (i >= home) ? i - home : i + capacity - home;
+    }
+
+  private:
+    inline size_type find_slot(const key_type& k) const
+    {
+        auto hash = hasher(k);
+        auto fp   = fingerprint(hash);
+
+        for (size_type i = index(hash);; i = mod(i + gsize))
+        {
+            swiss_group g(&ctrl[i]);
+            for (auto m = g.match(fp); m; m &= m - 1)
+            {
+                auto ti = i + __builtin_ctz(m);
+                if (table[ti].first == k) return ti;
+            }
+            if (g.match_empty()) return capacity;
+        }
+    }
+
+    // inserts an element that is not present (without growing)
+    inline void place(const value_intern& t)
+    {
+        auto hash = hasher(t.first);
+        for (size_type i = index(hash);; i = mod(i + gsize))
+        {
+            auto f = swiss_group(&ctrl[i]).match_free();
+            if (!f) continue;
+            auto ti    = i + __builtin_ctz(f);
+            table[ti]  = t;
+            ctrl[ti]   = fingerprint(hash);
+            return;
+        }
+    }
+
+    using probe_state = typename base_type::probe_state;
+
+    // one step scans one group, s.last holds the fingerprint
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        auto hash = hasher(k);
+        s.pos     = index(hash);
+        s.last    = fingerprint(hash);
+        s.next    = &ctrl[s.pos];
+    }
+
+    inline int
+    probe_step(const key_type& k, probe_state& s, value_intern*& result) const
+    {
+        swiss_group g(&ctrl[s.pos]);
+        for (auto m = g.match(int8_t(s.last)); m; m &= m - 1)
+        {
+            auto ti = s.pos + __builtin_ctz(m);
+            if (table[ti].first == k)
+            {
+                result = &table[ti];
+                return 1;
+            }
+        }
+        if (g.match_empty()) return -1;
+        s.pos  = mod(s.pos + gsize);
+        s.next = &ctrl[s.pos];
+        return 0;
+    }
+
+    // first slot of the hashed group
+    inline size_type index(size_type hash) const
+    {
+        return utils_tm::fastrange64(groups, hash) * gsize;
+    }
+    inline size_type mod(size_type i) const
+    {
+        return (i < capacity) ? i : i - capacity;
+    }
+    static inline int8_t fingerprint(size_type hash) { return hash & 0x7f; }
+
+    static inline size_type round_up(double cap)
+    {
+        return size_type(cap + gsize - 1) & ~(gsize - 1);
+    }
+    // at least one slot stays empty (it ends unsuccessful probes)
+    inline size_type grow_thresh(size_type cap) const
+    {
+        return std::min<size_type>(cap * beta / alpha, cap - 1);
+    }
+    // the base class allocates cap * alpha slots, this covers whole groups
+    static inline size_type group_cap(size_type cap, double alpha)
+    {
+        return round_up(cap * alpha) / alpha + 1;
+    }
+
+    // first free (empty or deleted) slot of the probing sequence
+    inline size_type first_free(size_type home) const
+    {
+        for (size_type i = home;; i = mod(i + gsize))
+        {
+            auto f = swiss_group(&ctrl[i]).match_free();
+            if (f) return i + __builtin_ctz(f);
+        }
+    }
+
+    // position of slot i within the probing sequence starting at home
+    inline size_type probe_group(size_type i, size_type home) const
+    {
+        return ((i >= home) ? i - home : i + capacity - home) / gsize;
+    }
+
+    // rehashes the elements in slots [0, ocap) within the (possibly
+    // grown) table, this also removes all tombstones
+    inline void rehash(size_type ocap)
+    {
+        // elements that still have to be placed are marked deleted
+        for (size_type i = 0; i < ocap; ++i)
+            ctrl[i] = (ctrl[i] >= 0) ? swiss_group::deleted : swiss_group::empty;
+        deleted = 0;
+
+        for (size_type i = 0; i < capacity; ++i)
+        {
+            if (ctrl[i] != swiss_group::deleted) continue;
+
+            auto hash   = hasher(table[i].first);
+            auto home   = index(hash);
+            auto target = first_free(home);
+
+            // the element is already in its first free group
+            if (probe_group(target, home) == probe_group(i, home))
+            {
+                ctrl[i] = fingerprint(hash);
+                continue;
+            }
+
+            if (ctrl[target] == swiss_group::empty)
+            {
+                table[target] = table[i];
+                table[i]      = value_intern();
+                ctrl[i]       = swiss_group::empty;
+            }
+            else
+            {
+                // target holds an element that is not yet placed, it is
+                // moved into slot i and handled next
+                std::swap(table[i], table[target]);
+                --i;
+            }
+            ctrl[target] = fingerprint(hash);
+        }
+    }
+
+    inline void grow()
+    {
+        // tombstones are removed without growing
+        if (n * alpha <= capacity)
+        {
+            rehash(capacity);
+            return;
+        }
+
+        resize(n);
+    }
+
+    inline void resize(size_type k)
+    {
+        auto ntable = this_type(k, alpha);
+
+        for (size_type i = 0; i < capacity; ++i)
+        {
+            if (ctrl[i] >= 0) ntable.place(table[i]);
+        }
+
+        size_type tn = n;
+        (*this)      = std::move(ntable);
+        n            = tn;
+    }
+
+    // control bytes are not zero when empty, they are always filled
+    inline void clear_slots(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+        std::fill(ctrl.get(), ctrl.get() + capacity, swiss_group::empty);
+        deleted = 0;
+    }
+
+  public:
+    inline static void print_init_header(otm::output_type& out)
+    {
+        out << otm::width(8) << "tombs";
+        base_type::print_init_header(out);
+    }
+
+    inline void print_init_data(otm::output_type& out)
+    {
+        out << otm::width(8) << deleted;
+        base_type::print_init_data(out);
+    }
+};
+
+
+template <class K, class D, class HF, class Conf>
+class prob_traits<prob_swiss<K, D, HF, Conf> >
+{
+  public:
+    using specialized_type   = prob_swiss<K, D, HF, Conf>;
+    using base_type          = prob_base<specialized_type>;
+    using hash_function_type = HF;
+    using config_type        = Conf;
+
+    using key_type    = K;
+    using mapped_type = D;
+};
+
+
+
+
+
+
+
+
+// *****************************************************************************
+// Same as Above, but Growing Using in Place Migration *************************
+// *****************************************************************************
+
+template <class K, class D, class HF = utils_tm::hash_tm::default_hash,
+          class Conf = triv_config>
+class prob_swiss_inplace
+    : public prob_traits<prob_swiss_inplace<K, D, HF, Conf> >::base_type
+{
+  private:
+    using this_type = prob_swiss_inplace<K, D, HF, Conf>;
+    using base_type = typename prob_traits<this_type>::base_type;
+
+    friend base_type;
+
+  public:
+    using size_type      = typename base_type::size_type;
+    using key_type       = typename prob_traits<this_type>::key_type;
+    using mapped_type    = typename prob_traits<this_type>::mapped_type;
+    using iterator       = typename base_type::iterator;
+    using const_iterator = typename base_type::const_iterator;
+
+  private:
+    using value_intern = typename base_type::value_intern;
+
+    static constexpr size_type gsize    = swiss_group::size;
+    static constexpr size_type max_size = 16ull << 30;
+
+  public:
+    prob_swiss_inplace(size_type cap = 0, double size_constraint = 1.1,
+                       size_type /*dis_steps*/ = 0, size_type /*seed*/ = 0)
+        : base_type(0, size_constraint), deleted(0)
+    {
+        // the pages are only touched once they are used, new[] of trivially
+        // destructible elements has no array cookie, thus, the memory is
+        // released by delete[] (unique_ptr<T[]>, see numa_make_array)
+        static_assert(std::is_trivially_destructible_v<value_intern>,
+                      "inplace tables need trivially destructible elements");
+        value_intern* temp =
+            static_cast<value_intern*>(::operator new[](max_size));
+        if (temp) table = std::unique_ptr<value_intern[]>(temp);
+        ctrl = std::unique_ptr<int8_t[]>(
+            new int8_t[max_size / sizeof(value_intern)]);
+
+        capacity = round_up((cap) ? cap * alpha : 2048 * alpha);
+        thresh   = grow_thresh(capacity);
+        groups   = capacity / gsize;
+
+        std::fill(table.get(), table.get() + capacity, value_intern());
+        std::fill(ctrl.get(), ctrl.get() + capacity, swiss_group::empty);
+    }
+
+    prob_swiss_inplace(const prob_swiss_inplace&) = delete;
+    prob_swiss_inplace& operator=(const prob_swiss_inplace&) = delete;
+
+    prob_swiss_inplace(prob_swiss_inplace&& rhs) = default;
+    prob_swiss_inplace& operator=(prob_swiss_inplace&&) = default;
+
+  private:
+    using base_type::alpha;
+    using base_type::beta;
+    using base_type::capacity;
+    using base_type::hasher;
+    using base_type::n;
+    using base_type::table;
+    using base_type::thresh;
+
+    size_type                 groups;
+    size_type                 deleted;
+    std::unique_ptr<int8_t[]> ctrl;
+
+    using base_type::dec_n;
+    using base_type::make_citerator;
+    using base_type::make_iterator;
+
+  public:
+    template <class M = mapped_type>
+    inline std::pair<iterator, bool>
+    insert(const key_type& k, const enable_if_mapped<M, M>& d)
+    {
+        return insert(std::make_pair(k, d));
+    }
+
+    inline std::pair<iterator, bool> insert(const value_intern& t)
+    {
+        auto      hash = hasher(t.first);
+        auto      fp   = fingerprint(hash);
+        size_type free = capacity;
+
+        for (size_type i = index(hash);; i = mod(i + gsize))
+        {
+            swiss_group g(&ctrl[i]);
+            for (auto m = g.match(fp); m; m &= m - 1)
+            {
+                auto ti = i + __builtin_ctz(m);
+                if (table[ti].first == t.first)
+                    return std::make_pair(make_iterator(&table[ti]), false);
+            }
+            if (free == capacity)
+            {
+                auto f = g.match_free();
+                if (f) free = i + __builtin_ctz(f);
+            }
+            if (g.match_empty()) break;
+        }
+
+        if (ctrl[free] == swiss_group::deleted) --deleted;
+        table[free] = t;
+        ctrl[free]  = fp;
+
+        // tombstones count towards the growing threshold
+        if (++n + deleted > thresh)
+        {
+            grow();
+            return std::make_pair(find(t.first), true);
+        }
+        return std::make_pair(make_iterator(&table[free]), true);
+    }
+
+    inline iterator find(const key_type& k)
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? make_iterator(&table[i]) : base_type::end();
+    }
+
+    inline const_iterator find(const key_type& k) const
+    {
+        auto i = find_slot(k);
+        return (i < capacity) ? make_citerator(&table[i]) : base_type::cend();
+    }
+
+    inline size_type erase(const key_type& k)
+    {
+        auto i = find_slot(k);
+        if (i == capacity) return 0;
+
+        table[i] = value_intern();
+        // a group with an empty slot never ended a probe, thus no
+        // probing sequence continues behind it
+        if (swiss_group(&ctrl[i & ~(gsize - 1)]).match_empty())
+            ctrl[i] = swiss_group::empty;
+        else
+        {
+            ctrl[i] = swiss_group::deleted;
+            ++deleted;
+        }
+        dec_n();
+        return 1;
+    }
+
+    inline int displacement(const key_type& k) const
+    {
+        auto i = find_slot(k);
+        if (i == capacity) return -1;
+        auto home = index(hasher(k));
+        return (i >= home) ? i - home : i + capacity - home;
+    }
+
+  private:
+    inline size_type find_slot(const key_type& k) const
+    {
+        auto hash = hasher(k);
+        auto fp   = fingerprint(hash);
+
+        for (size_type i = index(hash);; i = mod(i + gsize))
+        {
+            swiss_group g(&ctrl[i]);
+            for (auto m = g.match(fp); m; m &= m - 1)
+            {
+                auto ti = i + __builtin_ctz(m);
+                if (table[ti].first == k) return ti;
+            }
+            if (g.match_empty()) return capacity;
+        }
+    }
+
+    using probe_state = typename base_type::probe_state;
+
+    // one step scans one group, s.last holds the fingerprint
+    inline void probe_start(const key_type& k, probe_state& s) const
+    {
+        auto hash = hasher(k);
+        s.pos     = index(hash);
+        s.last    = fingerprint(hash);
+        s.next    = &ctrl[s.pos];
+    }
+
+    inline int
+    probe_step(const key_type& k, probe_state& s, value_intern*& result) const
+    {
+        swiss_group g(&ctrl[s.pos]);
+        for (auto m = g.match(int8_t(s.last)); m; m &= m - 1)
+        {
+            auto ti = s.pos + __builtin_ctz(m);
+            if (table[ti].first == k)
+            {
+                result = &table[ti];
+                return 1;
+            }
+        }
+        if (g.match_empty()) return -1;
+        s.pos  = mod(s.pos + gsize);
+        s.next = &ctrl[s.pos];
+        return 0;
+    }
+
+    // first slot of the hashed group
+    inline size_type index(size_type hash) const
+    {
+        return utils_tm::fastrange64(groups, hash) * gsize;
+    }
+    inline size_type mod(size_type i) const
+    {
+        return (i < capacity) ? i : i - capacity;
+    }
+    static inline int8_t fingerprint(size_type hash) { return hash & 0x7f; }
+
+    static inline size_type round_up(double cap)
+    {
+        return size_type(cap + gsize - 1) & ~(gsize - 1);
+    }
+    // at least one slot stays empty (it ends unsuccessful probes)
+    inline size_type grow_thresh(size_type cap) const
+    {
+        return std::min<size_type>(cap * beta / alpha, cap - 1);
+    }
+
+    // first free (empty or deleted) slot of the probing sequence
+    inline size_type first_free(size_type home) const
+    {
+        for (size_type i = home;; i = mod(i + gsize))
+        {
+            auto f = swiss_group(&ctrl[i]).match_free();
+            if (f) return i + __builtin_ctz(f);
+        }
+    }
+
+    // position of slot i within the probing sequence starting at home
+    inline size_type probe_group(size_type i, size_type home) const
+    {
+        return ((i >= home) ? i - home : i + capacity - home) / gsize;
+    }
+
+    // rehashes the elements in slots [0, ocap) within the (possibly
+    // grown) table, this also removes all tombstones
+    inline void rehash(size_type ocap)
+    {
+        // elements that still have to be placed are marked deleted
+        for (size_type i = 0; i < ocap; ++i)
+            ctrl[i] = (ctrl[i] >= 0) ? swiss_group::deleted : swiss_group::empty;
+        deleted = 0;
+
+        for (size_type i = 0; i < capacity; ++i)
+        {
+            if (ctrl[i] != swiss_group::deleted) continue;
+
+            auto hash   = hasher(table[i].first);
+            auto home   = index(hash);
+            auto target = first_free(home);
+
+            // the element is already in its first free group
+            if (probe_group(target, home) == probe_group(i, home))
+            {
+                ctrl[i] = fingerprint(hash);
+                continue;
+            }
+
+            if (ctrl[target] == swiss_group::empty)
+            {
+                table[target] = table[i];
+                table[i]      = value_intern();
+                ctrl[i]       = swiss_group::empty;
+            }
+            else
+            {
+                // target holds an element that is not yet placed, it is
+                // moved into slot i and handled next
+                std::swap(table[i], table[target]);
+                --i;
+            }
+            ctrl[target] = fingerprint(hash);
+        }
+    }
+
+    inline void grow() { grow_to(n); }
+
+    // see prob_linear_inplace::resize
+    inline void resize(size_type k)
+    {
+        k = std::max<size_type>(k, 500);
+        if (round_up(k * alpha) >= capacity)
+        {
+            grow_to(k);
+            return;
+        }
+        auto buffer = base_type::take_elements();
+        capacity    = round_up(k * alpha);
+        thresh      = grow_thresh(capacity);
+        groups      = capacity / gsize;
+        for (auto& e : buffer) insert(e);
+    }
+
+    // control bytes are not zero when empty, they are always filled
+    inline void clear_slots(clear_mode mode)
+    {
+        zero_range(table.get(), table.get() + capacity, mode);
+        std::fill(ctrl.get(), ctrl.get() + capacity, swiss_group::empty);
+        deleted = 0;
+    }
+
+    inline void grow_to(size_type k)
+    {
+        // does not grow, if only tombstones have to be removed
+        size_type ocap = capacity;
+        size_type ncap = std::max(round_up(k * alpha), capacity);
+
+        std::fill(table.get() + capacity, table.get() + ncap, value_intern());
+        std::fill(ctrl.get() + capacity, ctrl.get() + ncap,
+                  swiss_group::empty);
+
+        capacity = ncap;
+        thresh   = grow_thresh(ncap);
+        groups   = ncap / gsize;
+
+        rehash(ocap);
+    }
+
+  public:
+    inline static void print_init_header(otm::output_type& out)
+    {
+        out << otm::width(8) << "tombs";
+        base_type::print_init_header(out);
+    }
+
+    inline void print_init_data(otm::output_type& out)
+    {
+        out << otm::width(8) << deleted;
+        base_type::print_init_data(out);
+    }
+};
+
+
+template <class K, class D, class HF, class Conf>
+class prob_traits<prob_swiss_inplace<K, D, HF, Conf> >
+{
+  public:
+    using specialized_type   = prob_swiss_inplace<K, D, HF, Conf>;
+    using base_type          = prob_base<specialized_type>;
+    using hash_function_type = HF;
+    using config_type        = Conf;
+
+    using key_type    = K;
+    using mapped_type = D;
+};
+
+} // namespace dysect
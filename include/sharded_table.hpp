@@ -0,0 +1,299 @@
+#pragma once
+
+/*******************************************************************************
+ * include/sharded_table.hpp
+ *
+ * sharded_table partitions the keys over S independent tables of any
+ * type (shard = high bits of an additional hash function).  Used
+ * directly, it behaves like one sequential table.
+ *
+ * In delegation mode (start_workers), each shard is owned by one worker
+ * thread that is pinned to a core.  Other threads never touch the
+ * shards, they buffer requests in a handle and execute() sends one
+ * batch per shard to the owning workers and waits for the answers.
+ * Thus, every table type scales to multiple cores without being
+ * concurrent itself.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utils/default_hash.hpp"
+#include "utils/pin_thread.hpp"
+
+namespace dysect
+{
+
+template <class Table, class HF = utils_tm::hash_tm::default_hash>
+class sharded_table
+{
+  private:
+    using this_type = sharded_table<Table, HF>;
+
+  public:
+    using table_type     = Table;
+    using key_type       = typename Table::key_type;
+    using mapped_type    = typename Table::mapped_type;
+    using iterator       = typename Table::iterator;
+    using const_iterator = typename Table::const_iterator;
+    using size_type      = size_t;
+
+    enum class op_type : uint8_t
+    {
+        insert,
+        find,
+        erase
+    };
+
+    // one request, the owning worker stores its result in place (success:
+    // inserted/found/erased, mapped: the found value)
+    struct request
+    {
+        op_type     op;
+        bool        success;
+        key_type    key;
+        mapped_type mapped;
+    };
+
+    class handle;
+
+    // the capacity is split evenly, shards is rounded up to a power of 2
+    sharded_table(size_type cap = 0, double size_constraint = 1.1,
+                  size_type dis_steps = 0, size_type shards = 8,
+                  uint64_t seed = 0x9e3779b97f4a7c15ull)
+        : hasher(seed)
+    {
+        shard_bits = 0;
+        while ((1ull << shard_bits) < shards) ++shard_bits;
+        n_shards = 1ull << shard_bits;
+
+        for (size_type i = 0; i < n_shards; ++i)
+            shard_data.emplace_back(std::make_unique<shard_type>(
+                cap / n_shards, size_constraint, dis_steps));
+    }
+
+    sharded_table(const sharded_table&) = delete;
+    sharded_table& operator=(const sharded_table&) = delete;
+
+    ~sharded_table() { stop_workers(); }
+
+    // Direct (sequential) access **********************************************
+    // not allowed while workers are running
+    inline std::pair<iterator, bool>
+    insert(const key_type& k, const mapped_type& d)
+    {
+        return get_shard(k).insert(k, d);
+    }
+    inline iterator  find(const key_type& k) { return get_shard(k).find(k); }
+    inline size_type erase(const key_type& k) { return get_shard(k).erase(k); }
+
+    // all tables use the same end (a null iterator)
+    inline iterator end() { return shard_data[0]->table.end(); }
+
+    inline size_type shard_count() const { return n_shards; }
+    inline size_type shard_of(const key_type& k) const
+    {
+        return (shard_bits) ? hasher(k) >> (64 - shard_bits) : 0;
+    }
+    inline table_type& get_shard(size_type i) { return shard_data[i]->table; }
+    inline table_type& get_shard(const key_type& k)
+    {
+        return shard_data[shard_of(k)]->table;
+    }
+
+    // Delegation **************************************************************
+    // worker i owns shard i and runs on core (first_core + i) % #cores
+    void start_workers(size_type first_core = 0)
+    {
+        size_type cores = std::max(1u, std::thread::hardware_concurrency());
+        for (size_type i = 0; i < n_shards; ++i)
+        {
+            auto& s  = *shard_data[i];
+            s.stop   = false;
+            s.worker = std::thread(
+                [&s, core = (first_core + i) % cores]() { work(s, core); });
+        }
+    }
+
+    // pending batches are answered before the workers stop
+    void stop_workers()
+    {
+        for (auto& s : shard_data)
+        {
+            if (!s->worker.joinable()) continue;
+            {
+                std::lock_guard<std::mutex> lock(s->mtx);
+                s->stop = true;
+            }
+            s->cv.notify_one();
+            s->worker.join();
+        }
+    }
+
+    handle get_handle() { return handle(*this); }
+
+  private:
+    // requests of one handle for one shard
+    struct batch
+    {
+        request*          reqs;
+        size_type         size;
+        std::atomic<bool> done;
+    };
+
+    struct alignas(64) shard_type
+    {
+        shard_type(size_type cap, double alpha, size_type steps)
+            : table(cap, alpha, steps)
+        {
+        }
+
+        table_type              table;
+        std::mutex              mtx;
+        std::condition_variable cv;
+        std::vector<batch*>     queue;
+        bool                    stop = false;
+        std::thread             worker;
+    };
+
+    HF                                       hasher;
+    size_type                                shard_bits;
+    size_type                                n_shards;
+    std::vector<std::unique_ptr<shard_type>> shard_data;
+
+    void submit(size_type i, batch* b)
+    {
+        auto& s = *shard_data[i];
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+            s.queue.push_back(b);
+        }
+        s.cv.notify_one();
+    }
+
+    static void work(shard_type& s, size_type core)
+    {
+        utils_tm::pin_to_core(core);
+
+        std::vector<batch*> local;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(s.mtx);
+                s.cv.wait(lock, [&s]() { return s.stop || !s.queue.empty(); });
+                if (s.queue.empty()) return;
+                std::swap(local, s.queue);
+            }
+            for (auto b : local)
+            {
+                for (size_type j = 0; j < b->size; ++j)
+                    execute_request(s.table, b->reqs[j]);
+                b->done.store(true, std::memory_order_release);
+            }
+            local.clear();
+        }
+    }
+
+    static inline void execute_request(table_type& table, request& r)
+    {
+        switch (r.op)
+        {
+        case op_type::insert:
+            r.success = table.insert(r.key, r.mapped).second;
+            break;
+        case op_type::find:
+        {
+            auto it   = table.find(r.key);
+            r.success = it != table.end();
+            if (r.success) r.mapped = (*it).second;
+            break;
+        }
+        case op_type::erase:
+            r.success = table.erase(r.key);
+            break;
+        }
+    }
+};
+
+
+
+// Handle (one per client thread) **********************************************
+
+template <class Table, class HF>
+class sharded_table<Table, HF>::handle
+{
+  public:
+    handle(sharded_table& table)
+        : table(table), buffers(table.n_shards), positions(table.n_shards),
+          batches(std::make_unique<batch[]>(table.n_shards))
+    {
+    }
+
+    // requests are buffered (and sorted by shard) until execute
+    inline void insert(const key_type& k, const mapped_type& d)
+    {
+        push(op_type::insert, k, d);
+    }
+    inline void find(const key_type& k) { push(op_type::find, k, {}); }
+    inline void erase(const key_type& k) { push(op_type::erase, k, {}); }
+
+    inline size_type pending() const { return results.size(); }
+
+    // sends all buffered requests to their shards and waits for the
+    // answers, results are in the order of the requests
+    const std::vector<request>& execute()
+    {
+        for (size_type i = 0; i < table.n_shards; ++i)
+        {
+            if (buffers[i].empty()) continue;
+            batches[i].reqs = buffers[i].data();
+            batches[i].size = buffers[i].size();
+            batches[i].done.store(false, std::memory_order_relaxed);
+            table.submit(i, &batches[i]);
+        }
+        for (size_type i = 0; i < table.n_shards; ++i)
+        {
+            if (buffers[i].empty()) continue;
+            while (!batches[i].done.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            for (size_type j = 0; j < buffers[i].size(); ++j)
+                results[positions[i][j]] = buffers[i][j];
+            buffers[i].clear();
+            positions[i].clear();
+        }
+        answered.swap(results);
+        results.clear();
+        return answered;
+    }
+
+  private:
+    sharded_table&                      table;
+    std::vector<std::vector<request>>   buffers;
+    std::vector<std::vector<size_type>> positions;
+    std::unique_ptr<batch[]>            batches;
+    std::vector<request>                results;
+    std::vector<request>                answered;
+
+    inline void push(op_type op, const key_type& k, const mapped_type& d)
+    {
+        size_type s = table.shard_of(k);
+        positions[s].push_back(results.size());
+        buffers[s].push_back(request{op, false, k, d});
+        results.emplace_back();
+    }
+};
+
+} // namespace dysect
@@ -0,0 +1,178 @@
+#pragma once
+
+/*******************************************************************************
+ * include/simd_probe.hpp
+ *
+ * simd_probe compares a key with the keys of multiple consecutive
+ * slots of a probing table at once, and finds empty slots in the same
+ * step.  64-bit and 32-bit integer keys are vectorized, if their slots
+ * contain only the key (sets) or the key and mapped data of the same
+ * size (AVX-512: 8 slots, 16 slots for 32-bit sets, AVX2: half as
+ * many).  All other tables use width 1 (the scalar loop).
+ *
+ * distance_probe scans the per-slot distance bytes of robin hood
+ * tables (SSE2: 16 slots per step).
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <immintrin.h>
+
+namespace dysect
+{
+
+template <class K, class E,
+          bool = std::is_integral<K>::value &&
+                 (sizeof(K) == 8 || sizeof(K) == 4) &&
+                 (sizeof(E) == sizeof(K) || sizeof(E) == 2 * sizeof(K))>
+struct simd_probe
+{
+    static constexpr size_t width = 1;
+};
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+template <class K, class E> struct simd_probe<K, E, true>
+{
+  private:
+    // slot i is represented by bit i*stride of each mask, 64-bit keys
+    // with mapped data take two vector loads per scan (32-bit keys one)
+    static constexpr size_t stride = sizeof(E) / sizeof(K);
+    static constexpr size_t loads  = (sizeof(K) == 8) ? stride : 1;
+#ifdef __AVX512F__
+    static constexpr size_t vector_bytes = 64;
+#else
+    static constexpr size_t vector_bytes = 32;
+#endif
+    static constexpr size_t   lanes = vector_bytes * loads / sizeof(K);
+    static constexpr uint32_t keys =
+        ((stride == 1) ? 0xffffu : 0x5555u) & ((1u << lanes) - 1);
+
+  public:
+    static constexpr size_t width = lanes / stride;
+
+    // returns the offset of the first slot that is either empty or
+    // contains k (width if there is none), found is set if it contains k
+    static inline size_t scan(const E* slots, K k, bool& found)
+    {
+        uint32_t match = 0;
+        uint32_t empty = 0;
+        auto     ptr   = reinterpret_cast<const char*>(slots);
+
+#ifdef __AVX512F__
+        const __m512i zero = _mm512_setzero_si512();
+        __m512i       v0   = _mm512_loadu_si512(ptr);
+        if constexpr (sizeof(K) == 4)
+        {
+            const __m512i kk = _mm512_set1_epi32(int32_t(k));
+            match            = _mm512_cmpeq_epi32_mask(v0, kk);
+            empty            = _mm512_cmpeq_epi32_mask(v0, zero);
+        }
+        else if constexpr (stride == 1)
+        {
+            const __m512i kk = _mm512_set1_epi64(int64_t(k));
+            match            = _mm512_cmpeq_epi64_mask(v0, kk);
+            empty            = _mm512_cmpeq_epi64_mask(v0, zero);
+        }
+        else
+        {
+            const __m512i kk = _mm512_set1_epi64(int64_t(k));
+            // masks are combined with kunpackb (shifting 8-bit masks in
+            // mask registers is miscompiled by some compilers)
+            __m512i v1 = _mm512_loadu_si512(ptr + 64);
+            match      = _mm512_kunpackb(_mm512_cmpeq_epi64_mask(v1, kk),
+                                         _mm512_cmpeq_epi64_mask(v0, kk));
+            empty      = _mm512_kunpackb(_mm512_cmpeq_epi64_mask(v1, zero),
+                                         _mm512_cmpeq_epi64_mask(v0, zero));
+        }
+#else
+        const __m256i zero = _mm256_setzero_si256();
+        if constexpr (sizeof(K) == 4)
+        {
+            const __m256i kk = _mm256_set1_epi32(int32_t(k));
+            const __m256i v =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+            match = _mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, kk)));
+            empty = _mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, zero)));
+        }
+        else
+        {
+            const __m256i kk = _mm256_set1_epi64x(int64_t(k));
+            for (size_t i = 0; i < stride; ++i)
+            {
+                __m256i v = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(ptr + 32 * i));
+                match |= uint32_t(_mm256_movemask_pd(
+                             _mm256_castsi256_pd(_mm256_cmpeq_epi64(v, kk))))
+                         << (4 * i);
+                empty |= uint32_t(_mm256_movemask_pd(
+                             _mm256_castsi256_pd(_mm256_cmpeq_epi64(v, zero))))
+                         << (4 * i);
+            }
+        }
+#endif
+        // odd lanes of slots with mapped data contain the data
+        match &= keys;
+        empty &= keys;
+
+        uint32_t hit = match | empty;
+        if (!hit) return width;
+        size_t off = __builtin_ctz(hit) / stride;
+        found      = (match >> (off * stride)) & 1;
+        return off;
+    }
+};
+#endif
+
+// distance bytes store the displacement of a slot's element plus one
+// (0 marks empty slots, 255 all displacements >= 254)
+struct distance_probe
+{
+#ifdef __SSE2__
+    static constexpr size_t width = 16;
+
+    // compares the bytes with first, first+1, ... (the displacements
+    // a key would have in these slots); returns the offset of the first
+    // slot holding an element with smaller displacement (width if there
+    // is none), candidates marks the slots with equal displacement
+    // before that offset (only these can contain the key)
+    static inline size_t
+    scan(const uint8_t* dist, uint8_t first, uint32_t& candidates)
+    {
+        const __m128i iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                           11, 12, 13, 14, 15);
+        const __m128i e =
+            _mm_adds_epu8(_mm_set1_epi8(char(first)), iota);
+        const __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(dist));
+
+        uint32_t eq = _mm_movemask_epi8(_mm_cmpeq_epi8(v, e));
+        // v < e  <=>  max(v, e) != v
+        uint32_t lt =
+            ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, e), v)) &
+            0xffff;
+
+        if (!lt)
+        {
+            candidates = eq;
+            return width;
+        }
+        size_t off = __builtin_ctz(lt);
+        candidates = eq & ((1u << off) - 1);
+        return off;
+    }
+#else
+    static constexpr size_t width = 1;
+#endif
+};
+
+} // namespace dysect
@@ -0,0 +1,486 @@
+#pragma once
+
+/*******************************************************************************
+ * include/string_table.hpp
+ *
+ * string_table maps strings to mapped data.  Strings are interned into
+ * a bump allocated string_arena, together with their mapped data.
+ * The wrapped table stores pairs of 64-bit fingerprints and arena
+ * offsets.  Lookups compare fingerprints first (inside the wrapped
+ * table) and the string itself only once the fingerprint matches.
+ * Different strings with the same fingerprint are chained through
+ * their arena records, therefore, no two words are ever merged.
+ *
+ * The arena never moves or reuses records, erased records are only
+ * marked (their memory is reclaimed when the table is destroyed).
+ * Thus, references to mapped data stay valid until they are erased.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "utils/output.hpp"
+
+namespace otm = utils_tm::out_tm;
+
+namespace dysect
+{
+
+// 8-byte aligned bump allocator, offsets encode the chunk in the upper bits
+template <size_t CHUNK_BITS = 20> class string_arena
+{
+  public:
+    using size_type = size_t;
+
+    static constexpr size_type chunk_bits = CHUNK_BITS;
+    static constexpr size_type chunk_size = 1ull << CHUNK_BITS;
+    static constexpr size_type chunk_mask = chunk_size - 1;
+
+    string_arena() : fill(chunk_size), bytes(0) {}
+
+    string_arena(const string_arena&) = delete;
+    string_arena& operator=(const string_arena&) = delete;
+
+    string_arena(string_arena&&) = default;
+    string_arena& operator=(string_arena&&) = default;
+
+    // returns the offset of the next allocation (without allocating it,
+    // a new chunk is only created by commit)
+    inline uint64_t reserve(size_type size) const
+    {
+        size = align(size);
+        if (fill + size > chunk_size) // larger records get their own chunk
+            return uint64_t(chunks.size()) << CHUNK_BITS;
+        return (uint64_t(chunks.size() - 1) << CHUNK_BITS) | fill;
+    }
+
+    // allocates the memory reserved last
+    inline void commit(size_type size)
+    {
+        size = align(size);
+        if (fill + size > chunk_size)
+        {
+            chunks.push_back(std::make_unique<char[]>(
+                (size > chunk_size) ? size : chunk_size));
+            fills.push_back(0);
+            fill = 0;
+        }
+        fill = (size > chunk_size) ? chunk_size : fill + size;
+        fills.back() = fill;
+        bytes += size;
+    }
+
+    // releases all chunks (records are never moved)
+    inline void clear()
+    {
+        chunks.clear();
+        fills.clear();
+        fill  = chunk_size;
+        bytes = 0;
+    }
+
+    inline char* operator[](uint64_t off) const
+    {
+        return chunks[off >> CHUNK_BITS].get() + (off & chunk_mask);
+    }
+
+    inline size_type n_chunks() const { return chunks.size(); }
+    inline size_type chunk_fill(size_type i) const { return fills[i]; }
+    inline size_type used_bytes() const { return bytes; }
+
+    static inline size_type align(size_type size) { return (size + 7) & ~7ull; }
+
+  private:
+    size_type                             fill;
+    size_type                             bytes;
+    std::vector<std::unique_ptr<char[]> > chunks;
+    std::vector<size_type>                fills;
+};
+
+
+
+
+template <template <class, class, class, class> class Table, class D,
+          class HF, class Conf>
+class string_table
+{
+  private:
+    using this_type  = string_table<Table, D, HF, Conf>;
+    using arena_type = string_arena<>;
+    using inner_type = Table<uint64_t, uint64_t, HF, Conf>;
+
+    template <bool> class iterator_type;
+
+    static_assert(std::is_trivially_copyable<D>::value &&
+                      alignof(D) <= 8,
+                  "mapped data is stored (unaligned) inside the arena");
+
+  public:
+    using size_type          = size_t;
+    using key_type           = std::string_view;
+    using mapped_type        = D;
+    using iterator           = iterator_type<false>;
+    using const_iterator     = iterator_type<true>;
+    using insert_return_type = std::pair<iterator, bool>;
+
+    string_table(size_type cap = 0, double size_constraint = 1.1,
+                 size_type dis_steps = 256, size_type seed = 0)
+        : n(0), inner(cap, size_constraint, dis_steps, seed)
+    {
+    }
+
+    string_table(const string_table&) = delete;
+    string_table& operator=(const string_table&) = delete;
+
+    string_table(string_table&&) = default;
+    string_table& operator=(string_table&&) = default;
+
+  private:
+    // arena record: header | mapped data | characters
+    struct record_header
+    {
+        uint64_t next; // next record with the same fingerprint
+        uint32_t len;
+        uint32_t erased;
+    };
+
+    static constexpr uint64_t  npos     = ~0ull;
+    static constexpr size_type data_off = sizeof(record_header);
+    static constexpr size_type str_off  = data_off + sizeof(mapped_type);
+
+    size_type  n;
+    inner_type inner;
+    arena_type arena;
+
+  public:
+    // Basic Hash Table Functionality ******************************************
+    iterator find(const key_type& k)
+    {
+        auto it = inner.find(fingerprint(k));
+        if (it == inner.end()) return end();
+
+        for (uint64_t off = it->second; off != npos; off = header(off)->next)
+        {
+            if (equal(off, k)) return iterator(this, off);
+        }
+        return end();
+    }
+
+    const_iterator find(const key_type& k) const
+    {
+        return const_cast<this_type*>(this)->find(k);
+    }
+
+    insert_return_type insert(const key_type& k, const mapped_type& d);
+    size_type          erase(const key_type& k);
+
+    // if k is present f(mapped) is applied in place, otherwise (k, init)
+    // is inserted (one probe of the fingerprint, see insert)
+    template <class F>
+    insert_return_type
+    upsert(const key_type& k, const mapped_type& init, F&& f)
+    {
+        auto r = insert(k, init);
+        if (!r.second && r.first != end()) f((*r.first).second);
+        return r;
+    }
+
+    // Easy use Accessors for std compliance ***********************************
+    iterator begin()
+    {
+        // chunks without records are skipped
+        size_type chunk = 0;
+        for (; chunk < arena.n_chunks() && !arena.chunk_fill(chunk); ++chunk) {}
+        if (chunk == arena.n_chunks()) return end();
+
+        auto it = iterator(this, uint64_t(chunk) << arena_type::chunk_bits);
+        if (header(it.off)->erased) it++;
+        return it;
+    }
+    const_iterator begin() const { return cbegin(); }
+    const_iterator cbegin() const
+    {
+        return const_cast<this_type*>(this)->begin();
+    }
+    iterator       end() { return iterator(this, npos); }
+    const_iterator end() const { return cend(); }
+    const_iterator cend() const { return const_iterator(this, npos); }
+
+    mapped_type& at(const key_type& k)
+    {
+        auto a = find(k);
+        if (a == end()) throw std::out_of_range("cannot find key");
+        return (*a).second;
+    }
+    const mapped_type& at(const key_type& k) const
+    {
+        return const_cast<this_type*>(this)->at(k);
+    }
+    mapped_type& operator[](const key_type& k)
+    {
+        auto t = insert(k, mapped_type());
+        return (*t.first).second;
+    }
+    size_type count(const key_type& k) const
+    {
+        return (find(k) != cend()) ? 1 : 0;
+    }
+
+    // Global fill state *******************************************************
+    inline bool      empty() const { return n == 0; }
+    inline size_type size() const { return n; }
+
+    // Capacity ****************************************************************
+    // the inner table stores one offset per fingerprint
+    inline void reserve(size_type k) { inner.reserve(k); }
+    inline void shrink_to_fit() { inner.shrink_to_fit(); }
+    inline void clear(clear_mode mode = clear_mode::lazy)
+    {
+        inner.clear(mode);
+        arena.clear();
+        n = 0;
+    }
+
+    // murmur2 (64A) over the characters, 0 is reserved for empty slots
+    static inline uint64_t fingerprint(const key_type& k)
+    {
+        constexpr uint64_t m = 0xc6a4a7935bd1e995ull;
+        constexpr int      r = 47;
+
+        const char* p   = k.data();
+        size_type   len = k.size();
+        uint64_t    h   = 0x8445d61a4e774912ull ^ (len * m);
+
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            uint64_t w;
+            std::memcpy(&w, p, 8);
+            w *= m;
+            w ^= w >> r;
+            w *= m;
+            h ^= w;
+            h *= m;
+        }
+        if (len)
+        {
+            uint64_t w = 0;
+            std::memcpy(&w, p, len);
+            h ^= w;
+            h *= m;
+        }
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return (h) ? h : 1;
+    }
+
+  private:
+    // Record access ***********************************************************
+    inline record_header* header(uint64_t off) const
+    {
+        return reinterpret_cast<record_header*>(arena[off]);
+    }
+    inline mapped_type* data(uint64_t off) const
+    {
+        return reinterpret_cast<mapped_type*>(arena[off] + data_off);
+    }
+    inline key_type string(uint64_t off) const
+    {
+        return key_type(arena[off] + str_off, header(off)->len);
+    }
+    inline bool equal(uint64_t off, const key_type& k) const
+    {
+        auto h = header(off);
+        return h->len == k.size() &&
+               !std::memcmp(arena[off] + str_off, k.data(), k.size());
+    }
+    static inline size_type record_size(size_type len)
+    {
+        return arena_type::align(str_off + len);
+    }
+
+    // allocates and writes the record at the reserved offset
+    inline void
+    write_record(uint64_t off, const key_type& k, const mapped_type& d,
+                 uint64_t next)
+    {
+        arena.commit(record_size(k.size()));
+        auto h    = header(off);
+        h->next   = next;
+        h->len    = k.size();
+        h->erased = 0;
+        std::memcpy(data(off), &d, sizeof(mapped_type));
+        std::memcpy(arena[off] + str_off, k.data(), k.size());
+    }
+
+  public:
+    inline static void print_init_header(otm::output_type& out)
+    {
+        inner_type::print_init_header(out);
+        out << otm::width(10) << "s_mem";
+    }
+
+    inline void print_init_data(otm::output_type& out)
+    {
+        inner.print_init_data(out);
+        out << otm::width(10) << arena.used_bytes();
+    }
+
+  private:
+    // Iterator (walks the arena) **********************************************
+    template <bool is_const> class iterator_type
+    {
+      private:
+        using table_ptr =
+            typename std::conditional<is_const, const this_type*,
+                                      this_type*>::type;
+        using mapped_ref =
+            typename std::conditional<is_const, const mapped_type&,
+                                      mapped_type&>::type;
+
+      public:
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using reference         = std::pair<const key_type, mapped_ref>;
+        using value_type        = reference;
+
+        struct pointer
+        {
+            reference  ref;
+            reference* operator->() { return &ref; }
+        };
+
+        iterator_type(table_ptr table, uint64_t off) : table(table), off(off)
+        {
+        }
+        template <bool b, class = typename std::enable_if<is_const || !b>::type>
+        iterator_type(const iterator_type<b>& rhs)
+            : table(rhs.table), off(rhs.off)
+        {
+        }
+
+        iterator_type& operator++(int)
+        {
+            auto& arena = table->arena;
+            do {
+                auto chunk = off >> arena_type::chunk_bits;
+                auto pos   = (off & arena_type::chunk_mask) +
+                           record_size(table->header(off)->len);
+                // also skips chunks without records
+                while (pos >= arena.chunk_fill(chunk))
+                {
+                    if (++chunk >= arena.n_chunks())
+                    {
+                        off = npos;
+                        return *this;
+                    }
+                    pos = 0;
+                }
+                off = (chunk << arena_type::chunk_bits) | pos;
+            } while (table->header(off)->erased);
+            return *this;
+        }
+
+        reference operator*() const
+        {
+            return reference(table->string(off), *table->data(off));
+        }
+        pointer operator->() const { return pointer{**this}; }
+
+        bool operator==(const iterator_type& rhs) const
+        {
+            return off == rhs.off;
+        }
+        bool operator!=(const iterator_type& rhs) const
+        {
+            return off != rhs.off;
+        }
+
+      private:
+        template <bool> friend class iterator_type;
+        friend this_type;
+
+        table_ptr table;
+        uint64_t  off;
+    };
+};
+
+
+
+// Implementation of main functionality ****************************************
+
+template <template <class, class, class, class> class Table, class D,
+          class HF, class Conf>
+inline typename string_table<Table, D, HF, Conf>::insert_return_type
+string_table<Table, D, HF, Conf>::insert(const key_type& k, const mapped_type& d)
+{
+    // the record is reserved first, thus the fingerprint is probed only once
+    auto off = arena.reserve(record_size(k.size()));
+    auto ins = inner.insert(fingerprint(k), off);
+
+    if (ins.second)
+    {
+        write_record(off, k, d, npos);
+        ++n;
+        return std::make_pair(iterator(this, off), true);
+    }
+    if (ins.first == inner.end()) return std::make_pair(end(), false);
+
+    uint64_t head = ins.first->second;
+    for (uint64_t o = head; o != npos; o = header(o)->next)
+    {
+        if (equal(o, k)) return std::make_pair(iterator(this, o), false);
+    }
+
+    // fingerprint collision: the new record becomes the head of the chain
+    write_record(off, k, d, head);
+    ins.first->second = off;
+    ++n;
+    return std::make_pair(iterator(this, off), true);
+}
+
+template <template <class, class, class, class> class Table, class D,
+          class HF, class Conf>
+inline typename string_table<Table, D, HF, Conf>::size_type
+string_table<Table, D, HF, Conf>::erase(const key_type& k)
+{
+    auto fp = fingerprint(k);
+    auto it = inner.find(fp);
+    if (it == inner.end()) return 0;
+
+    record_header* prev = nullptr;
+    for (uint64_t off = it->second; off != npos; off = header(off)->next)
+    {
+        if (!equal(off, k))
+        {
+            prev = header(off);
+            continue;
+        }
+
+        auto h    = header(off);
+        h->erased = 1;
+        if (prev)
+            prev->next = h->next;
+        else if (h->next != npos)
+            it->second = h->next;
+        else
+            inner.erase(fp);
+        --n;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace dysect
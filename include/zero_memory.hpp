@@ -0,0 +1,130 @@
+#pragma once
+
+/*******************************************************************************
+ * include/zero_memory.hpp
+ *
+ * Resets table memory to the all zero state, which is the empty
+ * representation of all slots and buckets.  clear_mode::lazy returns
+ * the whole pages of a range to the kernel (madvise MADV_DONTNEED),
+ * they are zero pages on their next access.  Therefore, clearing a
+ * huge table is cheap and its resident memory shrinks until it is
+ * refilled.  clear_mode::eager zeroes the range with multiple threads,
+ * the pages stay committed.
+ *
+ * Part of Project DySECT - https://github.com/TooBiased/DySECT.git
+ *
+ * Copyright (C) 2017 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace dysect
+{
+
+enum class clear_mode
+{
+    lazy,
+    eager
+};
+
+namespace zero_detail
+{
+
+// smaller ranges are zeroed directly (a system call costs more)
+static constexpr size_t lazy_min_bytes = 1ull << 16;
+// amount of memory per thread of the eager zeroing
+static constexpr size_t eager_min_bytes = 1ull << 26;
+
+inline size_t page_size()
+{
+#ifdef __linux__
+    static const size_t ps = sysconf(_SC_PAGESIZE);
+    return ps;
+#else
+    return 4096;
+#endif
+}
+
+inline void zero_parallel(char* ptr, size_t bytes)
+{
+    size_t p = std::min<size_t>(std::thread::hardware_concurrency(),
+                                bytes / eager_min_bytes);
+    if (p < 2)
+    {
+        std::memset(ptr, 0, bytes);
+        return;
+    }
+
+    // blocks are page aligned (no two threads touch the same page)
+    size_t block = (bytes / p + page_size() - 1) & ~(page_size() - 1);
+
+    std::vector<std::thread> threads;
+    threads.reserve(p - 1);
+    for (size_t i = 1; i < p; ++i)
+    {
+        size_t s = std::min(i * block, bytes);
+        size_t e = std::min(s + block, bytes);
+        threads.emplace_back([=]() { std::memset(ptr + s, 0, e - s); });
+    }
+    std::memset(ptr, 0, std::min(block, bytes));
+    for (auto& t : threads) t.join();
+}
+
+} // namespace zero_detail
+
+// zeroes [ptr, ptr+bytes), the memory has to be private anonymous memory
+// (heap or anonymous mappings, not file backed)
+inline void zero_memory(void* ptr, size_t bytes, clear_mode mode)
+{
+    char* cptr = static_cast<char*>(ptr);
+    if (mode == clear_mode::eager)
+    {
+        zero_detail::zero_parallel(cptr, bytes);
+        return;
+    }
+
+#ifdef __linux__
+    if (bytes >= zero_detail::lazy_min_bytes)
+    {
+        // only whole pages are dropped, the partial pages at both ends
+        // can contain other data (e.g. allocator headers)
+        size_t    mask = zero_detail::page_size() - 1;
+        uintptr_t b    = reinterpret_cast<uintptr_t>(cptr);
+        uintptr_t pb   = (b + mask) & ~mask;
+        uintptr_t pe   = (b + bytes) & ~mask;
+        if (pb < pe &&
+            !madvise(reinterpret_cast<void*>(pb), pe - pb, MADV_DONTNEED))
+        {
+            std::memset(cptr, 0, pb - b);
+            std::memset(reinterpret_cast<char*>(pe), 0, b + bytes - pe);
+            return;
+        }
+    }
+#endif
+    std::memset(cptr, 0, bytes);
+}
+
+// resets [begin, end) to T(), T() has to be all zero bytes for trivially
+// destructible types (std::pair of integers is not trivially copyable)
+template <class T> inline void zero_range(T* begin, T* end, clear_mode mode)
+{
+    if constexpr (std::is_trivially_destructible_v<T>)
+        zero_memory(begin, (end - begin) * sizeof(T), mode);
+    else
+        std::fill(begin, end, T());
+}
+
+} // namespace dysect
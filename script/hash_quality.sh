@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# compares the hash functions (DYSECT_HASHFCT) on random 64-bit keys:
+# displacement lengths (displ) and the maximum load before an insertion
+# fails (mxls), one build folder per hash function
+
+src_folder=".."
+outfolder="out"
+
+n=700000
+cap=1000000
+
+for hf in XXH3 MURMUR2 FMIX64 MULT_SHIFT TABULATION
+do
+    build="build_${hf}"
+    cmake -S ${src_folder} -B ${build} -DDYSECT_HASHFCT=${hf} > /dev/null
+    cmake --build ${build} -j --target \
+          displ_multi_cuckoo_standard displ_multi_dysect \
+          displ_triv_linear displ_hop_hopscotch \
+          mxls_multi_cuckoo_standard > /dev/null
+
+    for tab in ${build}/displ/displ_*
+    do
+        pname="$(basename -- $tab)"
+        ./$tab -n $n -cap $cap -it 3 -out ${outfolder}/${pname}_${hf}
+    done
+
+    for H in 2 3 4
+    do
+        ./${build}/mxls/mxls_multi_cuckoo_standard -n 2000000 -it 5 \
+            -bs 4 -nh $H -steps 512 -bfs \
+            -out ${outfolder}/mxls_multi_cuckoo_standard_nh${H}_${hf}
+    done
+done
@@ -0,0 +1,349 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/prob_concurrent.hpp"
+#include "include/sharded_table.hpp"
+#include "selection.hpp"
+#include "utils/command_line_parser.hpp"
+#include "utils/default_hash.hpp"
+#include "utils/output.hpp"
+#include "utils/pin_thread.hpp"
+namespace utm = utils_tm;
+namespace otm = utils_tm::out_tm;
+
+// runs f(id) on p threads (pinned to the cores 0..p-1), returns ms
+template <class F> double run_parallel(size_t p, F f)
+{
+    std::atomic_size_t       ready{0};
+    std::atomic_bool         go{false};
+    std::vector<std::thread> threads;
+    for (size_t id = 0; id < p; ++id)
+    {
+        threads.emplace_back([&, id]() {
+            utm::pin_to_core(id);
+            ++ready;
+            while (!go.load()) std::this_thread::yield();
+            f(id);
+        });
+    }
+    while (ready.load() < p) std::this_thread::yield();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    go.store(true);
+    for (auto& t : threads) t.join();
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0)
+               .count() /
+           1000.;
+}
+
+// both tables run the same read-mostly-plus-append workload: parallel
+// insertions of keys[0, n), successful finds, unsuccessful finds
+// (keys[n, 2n)), and a mix of finds with every period-th operation
+// appending a new key from keys[2n, ...)
+struct workload
+{
+    size_t   n;
+    size_t   p;
+    size_t   period;
+    size_t*  keys;
+    double   t_in, t_fn0, t_fn1, t_mix;
+    size_t   in_err, fi_err;
+
+    size_t lb(size_t id, size_t b, size_t e) const
+    {
+        return b + (e - b) * id / p;
+    }
+    size_t appended(size_t j) const { return keys[2 * n + j / period]; }
+};
+
+template <class Config>
+struct Test
+{
+    using table_type     = HASHTYPE<size_t, size_t, test_hash_type, Config>;
+    using sharded_type   = dysect::sharded_table<table_type>;
+    using concurrent_type =
+        dysect::prob_linear_concurrent<size_t, size_t, test_hash_type>;
+    // same table with bucket_versions (lock-free find_concurrent)
+    using versioned_type = HASHTYPE<
+        size_t, size_t, test_hash_type,
+        dysect::cuckoo_config<Config::bs, Config::nh, Config::tl,
+                              dysect::cuckoo_displacement::bfs, false,
+                              typename Config::history_type,
+                              typename Config::growth_type,
+                              dysect::bucket_versions<> > >;
+
+    // each thread uses its own handle of the concurrent table
+    static void run_concurrent(workload& w, size_t cap, double alpha)
+    {
+        concurrent_type    table(cap, alpha);
+        std::atomic_size_t in_errors{0};
+        std::atomic_size_t fin_errors{0};
+
+        auto block = [&](size_t b, size_t e, auto&& op) {
+            return run_parallel(w.p, [&, b, e](size_t id) {
+                auto h = table.get_handle();
+                for (size_t j = w.lb(id, b, e); j < w.lb(id + 1, b, e); ++j)
+                    op(h, j);
+            });
+        };
+
+        w.t_in = block(0, w.n, [&](auto& h, size_t j) {
+            if (!h.insert(w.keys[j], j)) ++in_errors;
+        });
+        w.t_fn0 = block(0, w.n, [&](auto& h, size_t j) {
+            auto r = h.find(w.keys[j]);
+            if (!r.first || r.second != j) ++fin_errors;
+        });
+        w.t_fn1 = block(w.n, 2 * w.n, [&](auto& h, size_t j) {
+            auto r = h.find(w.keys[j]);
+            if (r.first && w.keys[r.second] != w.keys[j]) ++fin_errors;
+        });
+        w.t_mix = block(0, w.n, [&](auto& h, size_t j) {
+            if (j % w.period == 0)
+            {
+                if (!h.insert(w.appended(j), j)) ++in_errors;
+            }
+            else if (!h.find(w.keys[j]).first)
+                ++fin_errors;
+        });
+
+        w.in_err = in_errors.load();
+        w.fi_err = fin_errors.load();
+    }
+
+    // one writer (thread 0) and p - 1 readers that use find_concurrent,
+    // the capacity is reserved, since versioned tables do not reallocate;
+    // in the mixed phase the writer appends every period-th key and
+    // reassigns the others (insert_or_assign) while the readers search;
+    // insertions into a full versioned table throw (counted as errors)
+    static void run_versioned(workload& w, size_t cap, double alpha,
+                              size_t steps)
+    {
+        versioned_type table(cap, alpha, steps);
+
+        std::atomic_size_t in_errors{0};
+        std::atomic_size_t fin_errors{0};
+        if (!table.reserve_exclusive(w.n + w.n / w.period + 1)) ++in_errors;
+
+        auto write = [&](auto&& op) {
+            try
+            {
+                op();
+            }
+            catch (const std::length_error&)
+            {
+                ++in_errors;
+            }
+        };
+
+        auto find = [&](size_t b, size_t e, auto&& check) {
+            return run_parallel(w.p, [&, b, e](size_t id) {
+                for (size_t j = w.lb(id, b, e); j < w.lb(id + 1, b, e); ++j)
+                    check(j, table.find_concurrent(w.keys[j]));
+            });
+        };
+
+        w.t_in = run_parallel(1, [&](size_t) {
+            for (size_t j = 0; j < w.n; ++j)
+                write([&]() {
+                    if (!table.insert(w.keys[j], j).second) ++in_errors;
+                });
+        });
+        w.t_fn0 = find(0, w.n, [&](size_t j, const auto& r) {
+            if (!r.first || r.second != j) ++fin_errors;
+        });
+        w.t_fn1 = find(w.n, 2 * w.n, [&](size_t j, const auto& r) {
+            if (r.first && w.keys[r.second] != w.keys[j]) ++fin_errors;
+        });
+
+        size_t readers = std::max<size_t>(w.p, 2) - 1;
+        w.t_mix        = run_parallel(readers + 1, [&](size_t id) {
+            if (id == 0)
+            {
+                for (size_t j = 0; j < w.n; ++j)
+                    write([&]() {
+                        if (j % w.period)
+                            table.insert_or_assign(w.keys[j], j);
+                        else if (!table.insert(w.appended(j), j).second)
+                            ++in_errors;
+                    });
+                return;
+            }
+            size_t b = w.n * (id - 1) / readers;
+            size_t e = w.n * id / readers;
+            for (size_t j = b; j < e; ++j)
+            {
+                auto r = table.find_concurrent(w.keys[j]);
+                if (!r.first || r.second != j) ++fin_errors;
+            }
+        });
+        if (table.memory_pressure()) ++in_errors;
+
+        // a table without reserved capacity has to fail loudly once full
+        versioned_type small(0, alpha, steps);
+        bool           thrown = false;
+        try
+        {
+            for (size_t k = 1; k <= 4 * (w.n + 1024); ++k) small.insert(k, k);
+        }
+        catch (const std::length_error&)
+        {
+            thrown = true;
+        }
+        if (!thrown) ++in_errors;
+
+        w.in_err = in_errors.load();
+        w.fi_err = fin_errors.load();
+    }
+
+    // the clients delegate batches of requests to the shard workers
+    static void run_sharded(workload& w, size_t cap, double alpha,
+                            size_t steps, size_t shards, size_t batch)
+    {
+        sharded_type table(cap, alpha, steps, shards);
+        // the workers run on the cores after the clients
+        table.start_workers(w.p);
+
+        std::atomic_size_t in_errors{0};
+        std::atomic_size_t fin_errors{0};
+
+        auto block = [&](size_t b, size_t e, auto&& submit, auto&& check) {
+            return run_parallel(w.p, [&, b, e](size_t id) {
+                size_t le    = w.lb(id + 1, b, e);
+                auto   h     = table.get_handle();
+                size_t first = w.lb(id, b, e);
+                for (size_t j = first; j < le; ++j)
+                {
+                    submit(h, j);
+                    if (h.pending() < batch && j + 1 < le) continue;
+                    auto& res = h.execute();
+                    for (size_t r = 0; r < res.size(); ++r)
+                        check(res[r], first + r);
+                    first = j + 1;
+                }
+            });
+        };
+
+        w.t_in = block(
+            0, w.n, [&](auto& h, size_t j) { h.insert(w.keys[j], j); },
+            [&](const auto& r, size_t) {
+                if (!r.success) ++in_errors;
+            });
+        w.t_fn0 = block(
+            0, w.n, [&](auto& h, size_t j) { h.find(w.keys[j]); },
+            [&](const auto& r, size_t j) {
+                if (!r.success || r.mapped != j) ++fin_errors;
+            });
+        w.t_fn1 = block(
+            w.n, 2 * w.n, [&](auto& h, size_t j) { h.find(w.keys[j]); },
+            [&](const auto& r, size_t j) {
+                if (r.success && w.keys[r.mapped] != w.keys[j]) ++fin_errors;
+            });
+        w.t_mix = block(
+            0, w.n,
+            [&](auto& h, size_t j) {
+                if (j % w.period == 0)
+                    h.insert(w.appended(j), j);
+                else
+                    h.find(w.keys[j]);
+            },
+            [&](const auto& r, size_t j) {
+                if (!r.success) ++((j % w.period == 0) ? in_errors : fin_errors);
+            });
+
+        table.stop_workers();
+
+        w.in_err = in_errors.load();
+        w.fi_err = fin_errors.load();
+    }
+
+    int operator()(size_t it, size_t n, size_t cap, size_t steps, double alpha,
+                   size_t p, size_t shards, size_t batch, size_t period)
+    {
+        otm::out() << otm::width(7) << "# table" << otm::width(4) << "it"
+                   << otm::width(8) << "alpha" << otm::width(4) << "p"
+                   << otm::width(9) << "cap" << otm::width(9) << "n_full"
+                   << otm::width(10) << "t_in" << otm::width(10) << "t_find+"
+                   << otm::width(10) << "t_find-" << otm::width(10) << "t_mix"
+                   << otm::width(9) << "in_err" << otm::width(9) << "fi_err"
+                   << std::endl;
+
+        constexpr size_t range = (1ull << 63) - 1;
+
+        size_t  appends = n / period + 1;
+        size_t* keys    = new size_t[2 * n + appends];
+
+        std::uniform_int_distribution<uint64_t> dis(1, range);
+        std::mt19937_64                         re;
+
+        for (size_t i = 0; i < 2 * n + appends; ++i) { keys[i] = dis(re); }
+
+        auto print = [&](const char* name, size_t i, const workload& w) {
+            otm::out() << otm::width(7) << name << otm::width(4) << i
+                       << otm::width(8) << alpha << otm::width(4) << p
+                       << otm::width(9) << cap << otm::width(9) << n
+                       << otm::width(10) << w.t_in << otm::width(10)
+                       << w.t_fn0 << otm::width(10) << w.t_fn1
+                       << otm::width(10) << w.t_mix << otm::width(9)
+                       << w.in_err << otm::width(9) << w.fi_err << std::endl;
+        };
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            workload w{n, p, period, keys, 0., 0., 0., 0., 0, 0};
+            run_concurrent(w, cap, alpha);
+            print("conc", i, w);
+
+            w = workload{n, p, period, keys, 0., 0., 0., 0., 0, 0};
+            run_sharded(w, cap, alpha, steps, shards, batch);
+            print("shard", i, w);
+
+            w = workload{n, p, period, keys, 0., 0., 0., 0., 0, 0};
+            run_versioned(w, cap, alpha, steps);
+            print("vers", i, w);
+        }
+
+        delete[] keys;
+
+        return 0;
+    }
+};
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c(argn, argc);
+
+    size_t it     = c.int_arg("-it", 5);
+    size_t n      = c.int_arg("-n", 2000000);
+    size_t cap    = c.int_arg("-cap", n);
+    size_t steps  = c.int_arg("-steps", 512);
+    size_t p      = c.int_arg("-p", 4);
+    size_t shards = c.int_arg("-shards", p);
+    size_t batch  = c.int_arg("-batch", 1024);
+    // every period-th operation of the mixed phase is an insertion
+    size_t period = std::max<size_t>(c.int_arg("-period", 10), 1);
+
+    double alpha = c.double_arg("-alpha", 1.1);
+    double load  = c.double_arg("-load", 2.0);
+    double eps   = c.double_arg("-eps", 1.0 - load);
+    if (eps > 0.) alpha = 1. / (1. - eps);
+
+    if (c.bool_arg("-out") || c.bool_arg("-file"))
+    {
+        std::string name = c.str_arg("-out", "");
+        name             = c.str_arg("-file", name) + ".conc";
+        otm::out().set_file(name);
+    }
+
+    return Chooser::execute<Test, hist::history_none>(
+        c, it, n, cap, steps, alpha, p, shards, batch, period);
+}
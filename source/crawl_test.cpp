@@ -13,7 +13,20 @@ namespace otm = utils_tm::out_tm;
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <string_view>
+#include <type_traits>
 
+// tables with single probe updates count words with upsert
+template <class T, class K, class = void> struct has_upsert : std::false_type
+{
+};
+template <class T, class K>
+struct has_upsert<T, K,
+                  std::void_t<decltype(std::declval<T&>().upsert(
+                      std::declval<const K&>(), size_t(1),
+                      std::declval<void (*)(size_t&)>()))>> : std::true_type
+{
+};
 
 // TWO PROBLEMS!! cutoff words at the end of the buffer
 //                what happens if read reads only half a buffer
@@ -21,13 +34,35 @@ template <class Config>
 struct test_type
 {
     using table_type =
-        HASHTYPE<size_t, size_t, utm::hash_tm::default_hash, Config>;
+        HASHTYPE<size_t, size_t, test_hash_type, Config>;
     static constexpr size_t bsize = 2 * 1024 * 1024;
     static constexpr size_t hseed = 13358259232739045019ull;
+#ifdef STRING_KEYS
+    using key_type = std::string_view;
+#else
+    using key_type = size_t;
+#endif
+
+    // counts one occurrence of key, returns the insert result
+    static auto count(table_type& table, const key_type& key, size_t& max)
+    {
+        auto inc = [&max](size_t& v) { max = (++v < max) ? max : v; };
+        if constexpr (has_upsert<table_type, key_type>::value)
+            return table.upsert(key, 1, inc);
+        else
+        {
+            auto e = table.insert(key, 1);
+            if (!e.second && e.first != table.end()) inc((*e.first).second);
+            return e;
+        }
+    }
 
     int operator()(
         size_t it, size_t cap, double alpha, size_t steps, std::string inf_name)
     {
+        if constexpr (!has_upsert<table_type, key_type>::value)
+            otm::out() << "# table has no upsert (insert and increment)"
+                       << std::endl;
         otm::out() << otm::width(4) << "# it" << otm::width(8) << "alpha";
         table_type::print_init_header(otm::out());
         otm::out() << otm::width(9) << "cap" << otm::width(9) << "time"
@@ -65,21 +100,18 @@ struct test_type
                     {
                         if (j0 < j)
                         {
+#ifdef STRING_KEYS
+                            auto key = std::string_view(j0, j - j0);
+#else
                             size_t key = XXH64(j0, j - j0, hseed);
-                            auto   e   = table.insert(key, 1);
+#endif
+                            auto   e   = count(table, key, max);
                             if (e.second)
                                 ++individual;
+                            else if (e.first != table.end())
+                                ++contained;
                             else
-                            {
-                                if (e.first != table.end())
-                                {
-                                    size_t a = ++((*e.first).second);
-                                    max      = (a < max) ? max : a;
-                                    ++contained;
-                                }
-                                else
-                                    ++errors;
-                            }
+                                ++errors;
                         }
                         j0 = j + 1;
                     }
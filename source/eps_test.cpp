@@ -27,7 +27,7 @@ struct test_type
     // using table_type = ProbIndependentBase<HASHTYPE<size_t, size_t,
     // dysect::hash::default_hash, Config> >;
     using table_type =
-        HASHTYPE<size_t, size_t, utm::hash_tm::default_hash, Config>;
+        HASHTYPE<size_t, size_t, test_hash_type, Config>;
 
     constexpr static size_t block_size = 100000;
 
@@ -42,7 +42,7 @@ template <class Config>
 struct test_type
 {
     using table_type =
-        HASHTYPE<size_t, size_t, utm::hash_tm::default_hash, Config>;
+        HASHTYPE<size_t, size_t, test_hash_type, Config>;
 
     void print_hist(table_type& table)
     {
@@ -21,7 +21,7 @@ struct test_type
     // using table_type = ProbIndependentBase<HASHTYPE<size_t, size_t,
     // dysect::hash::default_hash, Config> >;
     using table_type =
-        HASHTYPE<size_t, size_t, utils_tm::hash_tm::default_hash, Config>;
+        HASHTYPE<size_t, size_t, test_hash_type, Config>;
 
     int operator()(size_t it, size_t n, size_t steps)
     {
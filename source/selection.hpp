@@ -40,6 +40,47 @@
 #define HASHTYPE dysect::cuckoo_dysect_inplace
 #endif // DYSECT_INPLACE
 
+#ifdef MULTI_DYSECT_INDIRECT
+#define MULTI
+#include "include/cuckoo_dysect.hpp"
+#define HASHTYPE dysect::cuckoo_dysect_indirect
+#endif // DYSECT_INDIRECT
+
+#ifdef MULTI_DYSECT_STRING
+#define MULTI
+#define STRING_KEYS
+#include "include/cuckoo_dysect.hpp"
+// string tables have no key parameter (only used by the crawl test)
+template <class K, class D, class HF, class Conf>
+using cuckoo_dysect_string_k = dysect::cuckoo_dysect_string<D, HF, Conf>;
+#define HASHTYPE cuckoo_dysect_string_k
+#endif // DYSECT_STRING
+
+#ifdef MULTI_DYSECT_INPLACE_STRING
+#define MULTI
+#define STRING_KEYS
+#include "include/cuckoo_dysect.hpp"
+template <class K, class D, class HF, class Conf>
+using cuckoo_dysect_inplace_string_k =
+    dysect::cuckoo_dysect_inplace_string<D, HF, Conf>;
+#define HASHTYPE cuckoo_dysect_inplace_string_k
+#endif // DYSECT_INPLACE_STRING
+
+#ifdef MULTI_DYSECT_COMPACT
+#define MULTI
+#define BFS_ONLY
+#include "include/cuckoo_dysect_compact.hpp"
+// quotienting needs a bijective hash function (the given one is ignored),
+// the table keeps no history (HistCount is ignored) and only displaces
+// with breadth first search (see Chooser)
+template <class K, class D, class HF, class Conf>
+using cuckoo_dysect_compact_bij = dysect::cuckoo_dysect_compact<
+    K, D, dysect::bijective_hash,
+    dysect::cuckoo_config<Conf::bs, Conf::nh, Conf::tl,
+                          dysect::cuckoo_displacement::bfs, Conf::fix_errors>>;
+#define HASHTYPE cuckoo_dysect_compact_bij
+#endif // DYSECT_COMPACT
+
 
 
 // cuckoo_independent_2lvl table
@@ -87,19 +128,51 @@
 // prob_robin tables
 
 #ifdef TRIV_ROBIN
-#define TRIV_CONFIG
+#define ROBIN_CONFIG
 #include "include/prob_robin.hpp"
 #define HASHTYPE dysect::prob_robin
 #endif // ROBIN
 
 #ifdef TRIV_ROBIN_INPLACE
-#define TRIV_CONFIG
+#define ROBIN_CONFIG
 #include "include/prob_robin.hpp"
 #define HASHTYPE dysect::prob_robin_inplace
 #endif // ROBIN_INPLACE
 
 
 
+// prob_swiss tables
+
+#ifdef TRIV_SWISS
+#define TRIV_CONFIG
+#include "include/prob_swiss.hpp"
+#define HASHTYPE dysect::prob_swiss
+#endif // SWISS
+
+#ifdef TRIV_SWISS_INPLACE
+#define TRIV_CONFIG
+#include "include/prob_swiss.hpp"
+#define HASHTYPE dysect::prob_swiss_inplace
+#endif // SWISS_INPLACE
+
+
+
+// prob_coalesced tables
+
+#ifdef TRIV_COALESCED
+#define COALESCED_CONFIG
+#include "include/prob_coalesced.hpp"
+#define HASHTYPE dysect::prob_coalesced
+#endif // COALESCED
+
+#ifdef TRIV_COALESCED_INPLACE
+#define COALESCED_CONFIG
+#include "include/prob_coalesced.hpp"
+#define HASHTYPE dysect::prob_coalesced_inplace
+#endif // COALESCED_INPLACE
+
+
+
 // prob_simple tables
 
 // #ifdef LINEAR_DOUBLING
@@ -143,7 +216,7 @@
 #endif
 
 #ifdef TRIV_MULTITABLE_ROBIN
-#define TRIV_CONFIG
+#define ROBIN_CONFIG
 #include "include/prob_multitable_base.hpp"
 #define HASHTYPE dysect::multitable_robin
 #endif
@@ -191,6 +264,22 @@
 #endif // NO TABLE IS DEFINED
 */
 
+// hash function of the tests: the integer hash functions are chosen
+// with DYSECT_HASHFCT (MULT_SHIFT, TABULATION, FMIX64), all other
+// options select the default hash from utils
+#include "include/integer_hash.hpp"
+#include "utils/default_hash.hpp"
+
+#if defined MULT_SHIFT
+using test_hash_type = dysect::multiply_shift_hash;
+#elif defined TABULATION
+using test_hash_type = dysect::tabulation_hash;
+#elif defined FMIX64
+using test_hash_type = dysect::fmix64_hash;
+#else
+using test_hash_type = utils_tm::hash_tm::default_hash;
+#endif
+
 // Two different variants of logging for Cuckoo Based Tables
 namespace hist
 {
@@ -229,6 +318,13 @@ struct Chooser
     {
         // return executeD<Functor, HistCount, DisRWalk>     ( c,
         // std::forward<Types>(param)...);
+#ifdef BFS_ONLY
+        if (!c.bool_arg("-bfs"))
+            std::cout << "ERROR: table only supports bfs displacement (use bfs)"
+                      << std::endl;
+        return executeD<Functor, HistCount, dysect::cuckoo_displacement::bfs>(
+            c, std::forward<Types>(param)...);
+#endif
         ///*
         if (c.bool_arg("-bfs"))
             return executeD<Functor, HistCount,
@@ -427,6 +523,31 @@ struct Chooser
         return f(std::forward<Types>(param)...);
     }
 
+#elif defined ROBIN_CONFIG
+    template <template <class> class Functor, class, class... Types>
+    inline static typename std::result_of<
+        Functor<dysect::robin_config<> >(Types&&...)>::type
+    execute(utm::command_line_parser& c, Types&&... param)
+    {
+        if (c.bool_arg("-nodist"))
+        {
+            Functor<dysect::robin_config<false> > f;
+            return f(std::forward<Types>(param)...);
+        }
+        Functor<dysect::robin_config<> > f;
+        return f(std::forward<Types>(param)...);
+    }
+
+#elif defined COALESCED_CONFIG
+    template <template <class> class Functor, class, class... Types>
+    inline static typename std::result_of<
+        Functor<dysect::coalesced_config<> >(Types&&...)>::type
+    execute(utm::command_line_parser&, Types&&... param)
+    {
+        Functor<dysect::coalesced_config<> > f;
+        return f(std::forward<Types>(param)...);
+    }
+
 #elif defined TRIV_CONFIG
     template <template <class> class Functor, class, class... Types>
     inline static
@@ -0,0 +1,171 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "include/sharded_table.hpp"
+#include "selection.hpp"
+#include "utils/command_line_parser.hpp"
+#include "utils/default_hash.hpp"
+#include "utils/output.hpp"
+#include "utils/pin_thread.hpp"
+namespace utm = utils_tm;
+namespace otm = utils_tm::out_tm;
+
+// runs f(id) on p threads (pinned to the cores 0..p-1), returns ms
+template <class F> double run_parallel(size_t p, F f)
+{
+    std::atomic_size_t       ready{0};
+    std::atomic_bool         go{false};
+    std::vector<std::thread> threads;
+    for (size_t id = 0; id < p; ++id)
+    {
+        threads.emplace_back([&, id]() {
+            utm::pin_to_core(id);
+            ++ready;
+            while (!go.load()) std::this_thread::yield();
+            f(id);
+        });
+    }
+    while (ready.load() < p) std::this_thread::yield();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    go.store(true);
+    for (auto& t : threads) t.join();
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0)
+               .count() /
+           1000.;
+}
+
+template <class Config>
+struct Test
+{
+    using table_type   = HASHTYPE<size_t, size_t, test_hash_type, Config>;
+    using sharded_type = dysect::sharded_table<table_type>;
+
+    int operator()(size_t it, size_t n, size_t cap, size_t steps, double alpha,
+                   size_t p, size_t shards, size_t batch)
+    {
+        otm::out() << otm::width(4) << "# it" << otm::width(8) << "alpha"
+                   << otm::width(4) << "p" << otm::width(7) << "shards"
+                   << otm::width(7) << "batch" << otm::width(9) << "cap"
+                   << otm::width(9) << "n_full" << otm::width(10) << "t_in"
+                   << otm::width(10) << "t_find+" << otm::width(10)
+                   << "t_find-" << otm::width(9) << "in_err" << otm::width(9)
+                   << "fi_err" << std::endl;
+
+        constexpr size_t range = (1ull << 63) - 1;
+
+        size_t* keys = new size_t[2 * n];
+
+        std::uniform_int_distribution<uint64_t> dis(1, range);
+        std::mt19937_64                         re;
+
+        for (size_t i = 0; i < 2 * n; ++i) { keys[i] = dis(re); }
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            sharded_type table(cap, alpha, steps, shards);
+            // the workers run on the cores after the clients
+            table.start_workers(p);
+
+            std::atomic_size_t in_errors{0};
+            std::atomic_size_t fin_errors{0};
+
+            // each client handles a contiguous block of [b, e) (i == key idx)
+            auto block = [&](size_t id, size_t b, size_t e, auto&& submit,
+                             auto&& check) {
+                size_t lb = b + (e - b) * id / p;
+                size_t le = b + (e - b) * (id + 1) / p;
+
+                auto   h     = table.get_handle();
+                size_t first = lb;
+                for (size_t j = lb; j < le; ++j)
+                {
+                    submit(h, j);
+                    if (h.pending() < batch && j + 1 < le) continue;
+                    auto& res = h.execute();
+                    for (size_t r = 0; r < res.size(); ++r)
+                        check(res[r], first + r);
+                    first = j + 1;
+                }
+            };
+
+            double d_in = run_parallel(p, [&](size_t id) {
+                block(
+                    id, 0, n,
+                    [&](auto& h, size_t j) { h.insert(keys[j], j); },
+                    [&](const auto& r, size_t) {
+                        if (!r.success) ++in_errors;
+                    });
+            });
+
+            double d_fn0 = run_parallel(p, [&](size_t id) {
+                block(
+                    id, 0, n,
+                    [&](auto& h, size_t j) { h.find(keys[j]); },
+                    [&](const auto& r, size_t j) {
+                        if (!r.success || r.mapped != j) ++fin_errors;
+                    });
+            });
+
+            double d_fn1 = run_parallel(p, [&](size_t id) {
+                block(
+                    id, n, 2 * n,
+                    [&](auto& h, size_t j) { h.find(keys[j]); },
+                    [&](const auto& r, size_t j) {
+                        if (r.success && keys[r.mapped] != keys[j])
+                            ++fin_errors;
+                    });
+            });
+
+            table.stop_workers();
+
+            otm::out() << otm::width(4) << i << otm::width(8) << alpha
+                       << otm::width(4) << p << otm::width(7)
+                       << table.shard_count() << otm::width(7) << batch
+                       << otm::width(9) << cap << otm::width(9) << n
+                       << otm::width(10) << d_in << otm::width(10) << d_fn0
+                       << otm::width(10) << d_fn1 << otm::width(9)
+                       << in_errors.load() << otm::width(9)
+                       << fin_errors.load() << std::endl;
+        }
+
+        delete[] keys;
+
+        return 0;
+    }
+};
+
+int main(int argn, char** argc)
+{
+    utm::command_line_parser c(argn, argc);
+
+    size_t it     = c.int_arg("-it", 5);
+    size_t n      = c.int_arg("-n", 2000000);
+    size_t cap    = c.int_arg("-cap", n);
+    size_t steps  = c.int_arg("-steps", 512);
+    size_t p      = c.int_arg("-p", 4);
+    size_t shards = c.int_arg("-shards", p);
+    size_t batch  = c.int_arg("-batch", 1024);
+
+    double alpha = c.double_arg("-alpha", 1.1);
+    double load  = c.double_arg("-load", 2.0);
+    double eps   = c.double_arg("-eps", 1.0 - load);
+    if (eps > 0.) alpha = 1. / (1. - eps);
+
+    if (c.bool_arg("-out") || c.bool_arg("-file"))
+    {
+        std::string name = c.str_arg("-out", "");
+        name             = c.str_arg("-file", name) + ".shard";
+        otm::out().set_file(name);
+    }
+
+    return Chooser::execute<Test, hist::history_none>(c, it, n, cap, steps,
+                                                      alpha, p, shards, batch);
+}
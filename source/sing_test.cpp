@@ -21,7 +21,7 @@ template <class Config>
 struct test_type
 {
     using table_type =
-        HASHTYPE<size_t, size_t, utm::hash_tm::default_hash, Config>;
+        HASHTYPE<size_t, size_t, test_hash_type, Config>;
 
 
     int operator()(size_t it, size_t n, size_t cap, size_t steps)
@@ -2,6 +2,9 @@
 #include <fstream>
 #include <iostream>
 #include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "selection.hpp"
 #include "utils/command_line_parser.hpp"
@@ -18,7 +21,7 @@ size_t                get_malloc() { return malloc_count_current(); }
 #else
 #include <malloc.h>
 static constexpr bool malloc_mode = false;
-constexpr size_t      get_malloc() { return mallinfo2().uordblks(); }
+size_t                get_malloc() { return mallinfo2().uordblks; }
 #endif
 #ifdef RSS_COUNT
 #include <stdio.h>
@@ -42,6 +45,59 @@ static constexpr bool rss_mode = false;
 constexpr size_t      get_rss() { return 0; }
 #endif
 
+// optional batch interfaces of some tables (used with -batch)
+template <class T, class = void> struct has_insert_batch : std::false_type
+{
+};
+template <class T>
+struct has_insert_batch<
+    T, std::void_t<decltype(std::declval<T&>().insert_batch(
+           std::declval<const std::pair<size_t, size_t>*>(), size_t(0)))>>
+    : std::true_type
+{
+};
+
+// NUMA placement of the dysect subtables (used with -numa)
+template <class T, class = void> struct has_numa_placement : std::false_type
+{
+};
+template <class T>
+struct has_numa_placement<
+    T, std::void_t<decltype(std::declval<T&>().place_subtables()),
+                   decltype(std::declval<const T&>().node_of_key(size_t(0)))>>
+    : std::true_type
+{
+};
+
+// found elements are returned as pointers (iterator::pointer)
+template <class T>
+using result_pointer =
+    std::conditional_t<std::is_pointer_v<typename T::iterator::pointer>,
+                       typename T::iterator::pointer, void*>;
+
+template <class T, class = void> struct has_find_batch : std::false_type
+{
+};
+template <class T>
+struct has_find_batch<
+    T, std::void_t<decltype(std::declval<T&>().find_batch(
+           std::declval<const size_t*>(), size_t(0),
+           std::declval<result_pointer<T>*>()))>> : std::true_type
+{
+};
+
+// interleaved lookups of the probing tables (used with -interleave)
+template <class T, class = void> struct has_find_interleaved : std::false_type
+{
+};
+template <class T>
+struct has_find_interleaved<
+    T, std::void_t<decltype(std::declval<T&>().template find_interleaved<16>(
+           std::declval<const size_t*>(), size_t(0),
+           std::declval<result_pointer<T>*>()))>> : std::true_type
+{
+};
+
 
 template <class Config>
 struct Test
@@ -49,9 +105,86 @@ struct Test
     // using table_type = ProbIndependentBase<HASHTYPE<size_t, size_t,
     // dysect::hash::default_hash, Config> >;
     using table_type =
-        HASHTYPE<size_t, size_t, utm::hash_tm::default_hash, Config>;
+        HASHTYPE<size_t, size_t, test_hash_type, Config>;
+
+    // insert_batch on the whole key range, returns the failed insertions
+    static size_t
+    insert_batched(table_type&                                   table,
+                   const std::vector<std::pair<size_t, size_t>>& elements)
+    {
+        size_t n = elements.size();
+        if constexpr (has_insert_batch<table_type>::value)
+            return n - table.insert_batch(elements.data(), n);
+        else
+            return n;
+    }
+
+    // find_batch (or find_interleaved) on keys[b, e), the results are
+    // checked like in the find loops (present: keys[i] maps to i),
+    // returns the errors
+    template <class Pointer>
+    static size_t find_batched(table_type& table, const size_t* keys, size_t b,
+                               size_t e, bool present, bool interleaved,
+                               Pointer* results)
+    {
+        if constexpr (has_find_batch<table_type>::value ||
+                      has_find_interleaved<table_type>::value)
+        {
+            if constexpr (has_find_interleaved<table_type>::value)
+            {
+                if (interleaved)
+                    table.template find_interleaved<16>(keys + b, e - b,
+                                                        results);
+            }
+            if constexpr (has_find_batch<table_type>::value)
+            {
+                if (!interleaved) table.find_batch(keys + b, e - b, results);
+            }
+
+            size_t errors = 0;
+            for (size_t i = b; i < e; ++i)
+            {
+                auto r = results[i - b];
+                if (present)
+                    errors += (!r || r->second != i) ? 1 : 0;
+                else
+                    errors += (r && keys[r->second] != keys[i]) ? 1 : 0;
+            }
+            return errors;
+        }
+        else
+            return 0;
+    }
+
+    // moves the subtables onto the online NUMA nodes (round robin)
+    static void place(table_type& table)
+    {
+        if constexpr (has_numa_placement<table_type>::value)
+            table.place_subtables();
+    }
+
+    // prints how many of the keys have their first choice on each node
+    static void print_nodes(const table_type& table, const size_t* keys,
+                            size_t n)
+    {
+        if constexpr (has_numa_placement<table_type>::value)
+        {
+            std::vector<size_t> count;
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t node = size_t(table.node_of_key(keys[i]) + 1);
+                if (node >= count.size()) count.resize(node + 1, 0);
+                ++count[node];
+            }
+            std::cout << "# keys per node:";
+            for (size_t j = 0; j < count.size(); ++j)
+                std::cout << " " << int(j) - 1 << ":" << count[j];
+            std::cout << std::endl;
+        }
+    }
 
-    int operator()(size_t it, size_t n, size_t cap, size_t steps, double alpha)
+    int operator()(size_t it, size_t n, size_t cap, size_t steps, double alpha,
+                   bool batch, bool interleave, bool numa)
     {
         otm::out() << otm::width(4) << "# it" << otm::width(8) << "alpha";
         table_type::print_init_header(otm::out());
@@ -72,27 +205,62 @@ struct Test
 
         for (size_t i = 0; i < 2 * n; ++i) { keys[i] = dis(re); }
 
+        // batched insertions (only tables with insert_batch)
+        bool batch_in = batch && has_insert_batch<table_type>::value;
+        if (batch && !batch_in)
+            std::cout << "ERROR: table has no insert_batch (use insert)"
+                      << std::endl;
+        std::vector<std::pair<size_t, size_t>> elements;
+        if (batch_in)
+            for (size_t i = 0; i < n; ++i) elements.emplace_back(keys[i], i);
+
+        // batched lookups (only tables with find_batch), interleaved
+        // lookups (only tables with find_interleaved)
+        bool inter_fn = interleave && has_find_interleaved<table_type>::value;
+        if (interleave && !inter_fn)
+            std::cout << "ERROR: table has no find_interleaved (use find)"
+                      << std::endl;
+        bool batch_fn = !inter_fn && batch && has_find_batch<table_type>::value;
+        if (batch && !batch_fn && !inter_fn)
+            std::cout << "ERROR: table has no find_batch (use find)"
+                      << std::endl;
+        batch_fn = batch_fn || inter_fn;
+        std::vector<result_pointer<table_type>> results;
+        if (batch_fn) results.resize(n);
+
+        // subtables on NUMA nodes (only dysect tables)
+        if (numa && !has_numa_placement<table_type>::value)
+            std::cout << "ERROR: table has no NUMA placement" << std::endl;
+
         for (size_t i = 0; i < it; ++i)
         {
             size_t start_rss = get_rss();
 
             table_type table(cap, alpha, steps);
+            if (numa) place(table);
 
             auto in_errors  = 0ull;
             auto fin_errors = 0ull;
 
             auto t0 = std::chrono::high_resolution_clock::now();
-            for (size_t i = 0; i < n && in_errors < 100; ++i)
-            {
-                if (!table.insert(keys[i], i).second) ++in_errors;
-            }
+            if (batch_in)
+                in_errors = insert_batched(table, elements);
+            else
+                for (size_t i = 0; i < n && in_errors < 100; ++i)
+                {
+                    if (!table.insert(keys[i], i).second) ++in_errors;
+                }
             auto t1 = std::chrono::high_resolution_clock::now();
 
             [[maybe_unused]] size_t final_rss = get_rss() - start_rss;
+            if (numa && i == 0) print_nodes(table, keys, n);
 
             auto t2 = std::chrono::high_resolution_clock::now();
             // const table_type& ctable = table;
-            for (size_t i = 0; i < n; ++i)
+            if (batch_fn)
+                fin_errors += find_batched(table, keys, 0, n, true, inter_fn,
+                                           results.data());
+            for (size_t i = 0; i < n && !batch_fn; ++i)
             {
                 auto e = table.find(keys[i]);
                 if ((e == table.end()) || ((*e).second != i))
@@ -102,7 +270,10 @@ struct Test
                 }
             }
             auto t3 = std::chrono::high_resolution_clock::now();
-            for (size_t i = n; i < 2 * n; ++i)
+            if (batch_fn)
+                fin_errors += find_batched(table, keys, n, 2 * n, false,
+                                           inter_fn, results.data());
+            for (size_t i = n; i < 2 * n && !batch_fn; ++i)
             {
                 auto e = table.find(keys[i]);
                 if ((e != table.end()) && (keys[(*e).second] != keys[i]))
@@ -134,9 +305,14 @@ struct Test
                        << otm::width(10) << d_in << otm::width(10) << d_fn0
                        << otm::width(10) << d_fn1 << otm::width(9) << in_errors
                        << otm::width(9) << fin_errors;
+            // the keys (and batched elements) are not part of the table
             if constexpr (malloc_mode)
                 otm::out() << otm::width(7)
-                           << double(get_malloc()) / double(8 * 2 * n) - 1.;
+                           << double(get_malloc() -
+                                     elements.capacity() * sizeof(elements[0]) -
+                                     results.capacity() * sizeof(results[0])) /
+                                      double(8 * 2 * n) -
+                                  1.;
             if constexpr (rss_mode) otm::out() << otm::width(7) << final_rss;
             otm::out() << std::endl;
         }
@@ -162,6 +338,13 @@ int main(int argn, char** argc)
     double eps   = c.double_arg("-eps", 1.0 - load);
     if (eps > 0.) alpha = 1. / (1. - eps);
 
+    // batched operations (if the table supports them)
+    bool batch = c.bool_arg("-batch");
+    // interleaved lookups (probing tables)
+    bool interleave = c.bool_arg("-interleave");
+    // subtables placed round robin on the NUMA nodes (dysect)
+    bool numa = c.bool_arg("-numa");
+
     if (c.bool_arg("-out") || c.bool_arg("-file"))
     {
         std::string name = c.str_arg("-out", "");
@@ -170,5 +353,6 @@ int main(int argn, char** argc)
     }
 
     return Chooser::execute<Test, hist::history_none>(c, it, n, cap, steps,
-                                                      alpha);
+                                                      alpha, batch,
+                                                      interleave, numa);
 }